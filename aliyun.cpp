@@ -0,0 +1,271 @@
+#include "aliyun.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QUuid>
+#include <QDebug>
+
+static const QString DEFAULT_ENDPOINT = "https://alidns.aliyuncs.com/";
+static const int HMAC_BLOCK_SIZE = 64;
+// 同时进行的记录操作数
+static const int MAX_CONCURRENT = 4;
+
+// RFC 3986 编码，与阿里云签名要求一致
+static QString percentEncode(const QString &value)
+{
+    return QString::fromLatin1(QUrl::toPercentEncoding(value));
+}
+
+static QString aliyunError(const QJsonObject &jsonObj)
+{
+    return QString("%1 (%2)").arg(jsonObj["Message"].toString(), jsonObj["Code"].toString());
+}
+
+Aliyun::Aliyun(RequestManager *requestManager)
+    : DnsProvider(requestManager)
+{
+    setMaxConcurrent(MAX_CONCURRENT);
+}
+
+bool Aliyun::loadConfig(const QJsonObject &config, QString &error)
+{
+    QString accessKey = config["access_key"].toString().trimmed();
+    QString secretKey = config["secret_key"].toString().trimmed();
+    QString domain = config["domain"].toString().trimmed();
+
+    if (accessKey.isEmpty() || secretKey.isEmpty() || domain.isEmpty()) {
+        error = "Please fill in all Aliyun settings";
+        return false;
+    }
+
+    // 账号或域名变化后，缓存的记录ID失效
+    if (accessKey != accessKey_ || domain != domain_) {
+        recordIds_.clear();
+    }
+    if (secretKey != secretKey_) {
+        prepareSigningKey(secretKey);
+    }
+
+    // endpoint 可指向本地模拟服务器
+    endpoint_ = config["endpoint"].toString(DEFAULT_ENDPOINT);
+    accessKey_ = accessKey;
+    secretKey_ = secretKey;
+    domain_ = domain;
+    return true;
+}
+
+void Aliyun::prepareSigningKey(const QString &secretKey)
+{
+    QByteArray key = (secretKey + "&").toUtf8();
+    if (key.size() > HMAC_BLOCK_SIZE) {
+        key = QCryptographicHash::hash(key, QCryptographicHash::Sha1);
+    }
+    key.append(QByteArray(HMAC_BLOCK_SIZE - key.size(), '\0'));
+
+    innerPad_ = key;
+    outerPad_ = key;
+    for (int i = 0; i < HMAC_BLOCK_SIZE; ++i) {
+        innerPad_[i] = char(key[i] ^ 0x36);
+        outerPad_[i] = char(key[i] ^ 0x5c);
+    }
+}
+
+QByteArray Aliyun::hmacSha1(const QByteArray &message) const
+{
+    QCryptographicHash inner(QCryptographicHash::Sha1);
+    inner.addData(innerPad_);
+    inner.addData(message);
+
+    QCryptographicHash outer(QCryptographicHash::Sha1);
+    outer.addData(outerPad_);
+    outer.addData(inner.result());
+    return outer.result();
+}
+
+QUrl Aliyun::signedUrl(const QString &action, const QMap<QString, QString> &params) const
+{
+    QMap<QString, QString> query = params;
+    query["Action"] = action;
+    query["Format"] = "JSON";
+    query["Version"] = "2015-01-09";
+    query["AccessKeyId"] = accessKey_;
+    query["SignatureMethod"] = "HMAC-SHA1";
+    query["SignatureVersion"] = "1.0";
+    query["SignatureNonce"] = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    query["Timestamp"] = QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd'T'HH:mm:ss'Z'");
+
+    // QMap 按键排序，即规范化请求字符串的顺序
+    QStringList pairs;
+    for (auto it = query.cbegin(); it != query.cend(); ++it) {
+        pairs.append(percentEncode(it.key()) + "=" + percentEncode(it.value()));
+    }
+    const QString canonical = pairs.join("&");
+    const QString stringToSign = "GET&" + percentEncode("/") + "&" + percentEncode(canonical);
+    const QString signature = QString::fromLatin1(hmacSha1(stringToSign.toUtf8()).toBase64());
+
+    return QUrl::fromEncoded((endpoint_ + "?" + canonical + "&Signature=" + percentEncode(signature)).toLatin1());
+}
+
+ManagedReply *Aliyun::call(const QString &action, const QMap<QString, QString> &params)
+{
+    // 共用同一个 QNetworkAccessManager，连接保持复用
+    return trackReply(requestManager_->get(QNetworkRequest(signedUrl(action, params))));
+}
+
+void Aliyun::updateDnsRecords(const QList<DnsRecord> &records)
+{
+    for (const DnsRecord &record : records) {
+        if (record.name.isEmpty()) {
+            emit updateFinished(false, QString("Please specify %1 record name").arg(record.type == "A" ? "IPv4" : "IPv6"));
+            return;
+        }
+    }
+
+    pending_ = records.size();
+    success_ = true;
+    messages_.clear();
+
+    if (pending_ == 0) {
+        emit updateFinished(true, "nothing to update");
+        return;
+    }
+
+    // 阿里云没有同步的批量修改接口，各记录并行处理并限制并发数
+    for (const DnsRecord &record : records) {
+        runLimited([this, record]() {
+            const QString recordId = recordIds_.value(recordKey(record));
+            if (recordId.isEmpty()) {
+                describeRecord(record);
+            } else {
+                modifyRecord(recordId, record, true);
+            }
+        });
+    }
+}
+
+void Aliyun::finishRecord(const DnsRecord &record, bool success, const QString &message)
+{
+    messages_.append(QString("%1 %2: %3").arg(record.type, record.name, message));
+    success_ = success_ && success;
+    releaseSlot();
+
+    if (--pending_ > 0) {
+        return;
+    }
+    emit updateFinished(success_, messages_.join("; "));
+}
+
+void Aliyun::describeRecord(const DnsRecord &record)
+{
+    QMap<QString, QString> params;
+    params["SubDomain"] = record.name + "." + domain_;
+    params["Type"] = record.type;
+
+    ManagedReply *reply = call("DescribeSubDomainRecords", params);
+    connect(reply, &ManagedReply::finished, this, [this, reply, record]() {
+        if (isStale(reply)) {
+            return;
+        }
+
+        QJsonObject jsonObj = QJsonDocument::fromJson(reply->readAll()).object();
+        if (reply->error() != QNetworkReply::NoError || jsonObj.contains("Code")) {
+            finishRecord(record, false, QString("Search record error: %1")
+                                            .arg(jsonObj.contains("Code") ? aliyunError(jsonObj) : reply->errorString()));
+            return;
+        }
+
+        const QJsonArray result = jsonObj["DomainRecords"].toObject()["Record"].toArray();
+        if (result.isEmpty()) {
+            addRecord(record);
+            return;
+        }
+        if (result.size() != 1) {
+            finishRecord(record, false, "Record ID count is not equal to 1");
+            return;
+        }
+
+        const QJsonObject recordInfo = result.first().toObject();
+        const QString recordId = recordInfo["RecordId"].toString();
+        recordIds_.insert(recordKey(record), recordId);
+
+        if (recordInfo["Value"].toString() == record.content && (ttl_ == 1 || recordInfo["TTL"].toInt() == ttl_)) {
+            finishRecord(record, true, "unchanged");
+            return;
+        }
+        modifyRecord(recordId, record, false);
+    });
+}
+
+void Aliyun::addRecord(const DnsRecord &record)
+{
+    QMap<QString, QString> params;
+    params["DomainName"] = domain_;
+    params["RR"] = record.name;
+    params["Type"] = record.type;
+    params["Value"] = record.content;
+    // 自动 TTL 不传，使用阿里云默认值
+    if (ttl_ != 1) {
+        params["TTL"] = QString::number(ttl_);
+    }
+
+    ManagedReply *reply = call("AddDomainRecord", params);
+    connect(reply, &ManagedReply::finished, this, [this, reply, record]() {
+        if (isStale(reply)) {
+            return;
+        }
+
+        QJsonObject jsonObj = QJsonDocument::fromJson(reply->readAll()).object();
+        if (reply->error() != QNetworkReply::NoError || jsonObj.contains("Code")) {
+            finishRecord(record, false, QString("Create record error: %1")
+                                            .arg(jsonObj.contains("Code") ? aliyunError(jsonObj) : reply->errorString()));
+            return;
+        }
+
+        recordIds_.insert(recordKey(record), jsonObj["RecordId"].toString());
+        finishRecord(record, true, "created");
+    });
+}
+
+void Aliyun::modifyRecord(const QString &recordId, const DnsRecord &record, bool cached)
+{
+    QMap<QString, QString> params;
+    params["RecordId"] = recordId;
+    params["RR"] = record.name;
+    params["Type"] = record.type;
+    params["Value"] = record.content;
+    if (ttl_ != 1) {
+        params["TTL"] = QString::number(ttl_);
+    }
+
+    ManagedReply *reply = call("UpdateDomainRecord", params);
+    connect(reply, &ManagedReply::finished, this, [this, reply, record, cached]() {
+        if (isStale(reply)) {
+            return;
+        }
+
+        QJsonObject jsonObj = QJsonDocument::fromJson(reply->readAll()).object();
+        const QString code = jsonObj["Code"].toString();
+
+        // 内容未变化时阿里云返回 DomainRecordDuplicate，稳定状态下一次请求即可确认
+        if (code == "DomainRecordDuplicate") {
+            finishRecord(record, true, "unchanged");
+            return;
+        }
+
+        // 缓存的记录已被删除或不属于当前账号，重新查询
+        if (cached && (code == "DomainRecordNotBelongToUser" || code.startsWith("InvalidRecordId"))) {
+            recordIds_.remove(recordKey(record));
+            describeRecord(record);
+            return;
+        }
+
+        if (reply->error() != QNetworkReply::NoError || !code.isEmpty()) {
+            finishRecord(record, false, QString("Update record error: %1")
+                                            .arg(!code.isEmpty() ? aliyunError(jsonObj) : reply->errorString()));
+            return;
+        }
+        finishRecord(record, true, "updated");
+    });
+}
@@ -0,0 +1,54 @@
+#ifndef ALIYUN_H
+#define ALIYUN_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QHash>
+#include <QUrl>
+#include <QJsonObject>
+
+#include "dnsprovider.h"
+
+// 阿里云解析（AliDNS），RPC 风格接口，HMAC-SHA1 签名
+class Aliyun : public DnsProvider
+{
+    Q_OBJECT
+public:
+    Aliyun(RequestManager *requestManager);
+
+    QString name() const override { return "Aliyun"; }
+    bool loadConfig(const QJsonObject &config, QString &error) override;
+
+    void updateDnsRecords(const QList<DnsRecord> &records) override;
+
+private:
+    // 签名密钥的内外填充只在密钥变化时计算一次
+    void prepareSigningKey(const QString &secretKey);
+    QByteArray hmacSha1(const QByteArray &message) const;
+    QUrl signedUrl(const QString &action, const QMap<QString, QString> &params) const;
+    ManagedReply *call(const QString &action, const QMap<QString, QString> &params);
+
+    static QString recordKey(const DnsRecord &record) { return record.type + " " + record.name; }
+    void describeRecord(const DnsRecord &record);
+    void addRecord(const DnsRecord &record);
+    void modifyRecord(const QString &recordId, const DnsRecord &record, bool cached);
+    void finishRecord(const DnsRecord &record, bool success, const QString &message);
+
+private:
+    QString endpoint_;
+    QString accessKey_;
+    QString secretKey_;
+    QString domain_;
+    QByteArray innerPad_;
+    QByteArray outerPad_;
+
+    // 记录ID缓存，命中时直接修改，省去查询
+    QHash<QString, QString> recordIds_;
+
+    int pending_ = 0;
+    bool success_ = true;
+    QStringList messages_;
+};
+
+#endif // ALIYUN_H
@@ -0,0 +1,138 @@
+#include "benchmark.h"
+
+#include <atomic>
+
+// 通过替换 malloc 系列函数统计分配；Qt 容器直接调用 malloc，替换 operator new 不够
+#if defined(__GLIBC__)
+
+#include <malloc.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+}
+
+static std::atomic<quint64> allocationCount{0};
+static std::atomic<qint64> allocatedBytes{0};
+static std::atomic<qint64> peak{0};
+
+static void *track(void *ptr)
+{
+    if (ptr) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        const qint64 size = qint64(malloc_usable_size(ptr));
+        const qint64 current = allocatedBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        qint64 previous = peak.load(std::memory_order_relaxed);
+        while (current > previous && !peak.compare_exchange_weak(previous, current, std::memory_order_relaxed)) {
+        }
+    }
+    return ptr;
+}
+
+extern "C" {
+
+void *malloc(size_t size)
+{
+    return track(__libc_malloc(size));
+}
+
+void *calloc(size_t count, size_t size)
+{
+    return track(__libc_calloc(count, size));
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    const qint64 previous = ptr ? qint64(malloc_usable_size(ptr)) : 0;
+    void *result = __libc_realloc(ptr, size);
+    if (result || size == 0) {
+        allocatedBytes.fetch_sub(previous, std::memory_order_relaxed);
+    }
+    return track(result);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    return track(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return track(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    void *result = track(__libc_memalign(alignment, size));
+    if (!result) {
+        return 12; // ENOMEM
+    }
+    *ptr = result;
+    return 0;
+}
+
+void free(void *ptr)
+{
+    if (ptr) {
+        allocatedBytes.fetch_sub(qint64(malloc_usable_size(ptr)), std::memory_order_relaxed);
+    }
+    __libc_free(ptr);
+}
+
+}
+
+bool AllocStats::isAvailable()
+{
+    return true;
+}
+
+quint64 AllocStats::count()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+qint64 AllocStats::liveBytes()
+{
+    return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+qint64 AllocStats::peakBytes()
+{
+    return peak.load(std::memory_order_relaxed);
+}
+
+void AllocStats::resetPeak()
+{
+    peak.store(allocatedBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+#else
+
+bool AllocStats::isAvailable()
+{
+    return false;
+}
+
+quint64 AllocStats::count()
+{
+    return 0;
+}
+
+qint64 AllocStats::liveBytes()
+{
+    return 0;
+}
+
+qint64 AllocStats::peakBytes()
+{
+    return 0;
+}
+
+void AllocStats::resetPeak()
+{
+}
+
+#endif
@@ -0,0 +1,87 @@
+#include "benchmark.h"
+#include "config.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+
+// 与实际使用相近的配置：三个服务商、动态 TTL、前缀委派和一个故障切换组
+static QJsonObject sampleConfig()
+{
+    QJsonObject providers;
+    providers["Cloudflare"] = QJsonObject{
+        {"api_key", "0123456789abcdef0123456789abcdef01234567"},
+        {"api_tokens", QJsonArray{"tokenA0123456789abcdef0123456789abcdef", "tokenB0123456789abcdef0123456789abcdef"}},
+        {"zone_id", "023e105f4ecef8ad9ca31a8372d0c353"},
+        {"domain", "example.com"}};
+    providers["Aliyun"] = QJsonObject{
+        {"access_key", "LTAI5tExampleAccessKey"},
+        {"secret_key", "ExampleSecretKey0123456789abcdef"},
+        {"domain", "example.com"}};
+    providers["DNSPod"] = QJsonObject{{"token", "123456,0123456789abcdef0123456789abcdef"}, {"domain", "example.com"}};
+
+    QJsonObject config;
+    config[KEY_LAST_PROVIDER] = "Cloudflare";
+    config[KEY_TARGET_PROVIDERS] = QJsonArray{"Cloudflare", "Aliyun", "DNSPod"};
+    config[KEY_CYCLE_BUDGET] = 30;
+    config[KEY_PUSH_SOCKET] = "ddns-qt";
+    config[KEY_HOST_COORDINATION] = true;
+    config["ipv4_record"] = "home";
+    config["ipv6_record"] = "home";
+    config["ttl"] = 300;
+    config["providers"] = providers;
+    config["damping"] = QJsonObject{{"stable_window", 30}, {"half_life", 300}};
+    config["dynamic_ttl"] = QJsonObject{{"enabled", true}, {"unstable_ttl", 60}, {"quiet_period", 1800}};
+    config["ipv6_prefix"] = QJsonObject{{"prefix_length", 56}, {"records", QJsonArray{
+        QJsonObject{{"name", "nas"}, {"suffix", "::10"}},
+        QJsonObject{{"name", "printer"}, {"suffix", "::20"}}}}};
+    config["failover"] = QJsonArray{QJsonObject{
+        {"record", "www"},
+        {"candidates", QJsonArray{QJsonObject{{"address", "203.0.113.10"}, {"probe", "https"}},
+                                  QJsonObject{{"address", "198.51.100.20"}, {"probe", "tcp"}, {"port", 443}}}}}};
+    return config;
+}
+
+QList<BenchResult> benchConfig(const BenchOptions &options)
+{
+    // 配置写到测试目录，不影响真实配置
+    QStandardPaths::setTestModeEnabled(true);
+    const QString configPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    QDir().mkpath(configPath);
+    QFile file(configPath + "/config.json");
+    if (!file.open(QIODevice::WriteOnly)) {
+        return {};
+    }
+    file.write(QJsonDocument(sampleConfig()).toJson());
+    file.close();
+
+    Config &config = Config::getInstance();
+    QList<BenchResult> results;
+
+    // 读取并解析配置文件
+    results.append(measureOps("config/load", options, 200, [&config](int ops) {
+        qint64 failures = 0;
+        for (int i = 0; i < ops; ++i) {
+            failures += config.init() != 0;
+        }
+        return failures;
+    }));
+
+    // 每轮更新读取的配置项
+    results.append(measureOps("config/lookup", options, 10000, [&config](int ops) {
+        qint64 sum = 0;
+        for (int i = 0; i < ops; ++i) {
+            sum += config.getTargetProviders().size();
+            sum += config.getIpv4RecordName().size();
+            sum += config.getRecordTtl();
+            sum += config.getConfig()["providers"].toObject()["Cloudflare"].toObject().size();
+        }
+        return sum;
+    }));
+
+    file.remove();
+    return results;
+}
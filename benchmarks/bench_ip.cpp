@@ -0,0 +1,54 @@
+#include "benchmark.h"
+#include "common.h"
+#include "ipdiscovery.h"
+
+#include <QStringList>
+
+// 各类输入混合：IPv4、IPv6、映射地址和无效字符串
+static const QStringList ADDRESSES = {
+    "203.0.113.45",
+    "10.0.0.1",
+    "2001:db8:85a3::8a2e:370:7334",
+    "fe80::1",
+    "::ffff:192.0.2.128",
+    "256.1.1.1",
+    "not an address",
+    "",
+};
+
+// 与 ipify 响应格式相同
+static QList<QByteArray> replies()
+{
+    QList<QByteArray> bodies;
+    bodies.append(R"({"ip":"203.0.113.45"})");
+    bodies.append(R"({"ip":"2001:db8:85a3::8a2e:370:7334"})");
+    // 纯文本格式的响应
+    bodies.append("198.51.100.7\n");
+    return bodies;
+}
+
+QList<BenchResult> benchIpParse(const BenchOptions &options)
+{
+    QList<BenchResult> results;
+
+    results.append(measureOps("ip/type", options, 100000, [](int ops) {
+        qint64 sum = 0;
+        for (int i = 0; i < ops; ++i) {
+            sum += getIpType(ADDRESSES.at(i % ADDRESSES.size()));
+        }
+        return sum;
+    }));
+
+    const QList<QByteArray> bodies = replies();
+    results.append(measureOps("ip/reply", options, 20000, [&bodies](int ops) {
+        qint64 valid = 0;
+        for (int i = 0; i < ops; ++i) {
+            const int index = i % bodies.size();
+            // 第二个响应来自 IPv6 接口
+            valid += !IpDiscovery::parseReply(bodies.at(index), index != 1).isEmpty();
+        }
+        return valid;
+    }));
+
+    return results;
+}
@@ -0,0 +1,128 @@
+#include "benchmark.h"
+#include "recordlistparser.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+// 网络层每次交付的数据量
+static const int CHUNK_SIZE = 16 * 1024;
+
+// 与 Cloudflare 列表接口相同格式的响应体，记录带有实际响应中的其他字段
+static QByteArray listResponse(int count)
+{
+    QJsonArray result;
+    for (int i = 0; i < count; ++i) {
+        QJsonObject record;
+        record["id"] = QString("%1").arg(i, 32, 16, QLatin1Char('0'));
+        record["zone_id"] = "023e105f4ecef8ad9ca31a8372d0c353";
+        record["zone_name"] = "example.com";
+        record["name"] = QString("host%1.example.com").arg(i);
+        record["type"] = "A";
+        record["content"] = QString("10.%1.%2.%3").arg((i >> 16) & 0xff).arg((i >> 8) & 0xff).arg(i & 0xff);
+        record["proxiable"] = true;
+        record["proxied"] = false;
+        record["ttl"] = 300;
+        record["meta"] = QJsonObject{{"auto_added", false}, {"source", "primary"}};
+        record["comment"] = QJsonValue::Null;
+        record["tags"] = QJsonArray();
+        record["created_on"] = "2024-01-01T00:00:00.000000Z";
+        record["modified_on"] = "2024-01-01T00:00:00.000000Z";
+        result.append(record);
+    }
+
+    QJsonObject body;
+    body["result"] = result;
+    body["success"] = true;
+    body["errors"] = QJsonArray();
+    body["messages"] = QJsonArray();
+    body["result_info"] = QJsonObject{{"page", 1}, {"per_page", count}, {"count", count},
+                                      {"total_count", count}, {"total_pages", 1}};
+    return QJsonDocument(body).toJson(QJsonDocument::Compact);
+}
+
+// 原来的做法：收齐整个响应体后构建文档，再取出需要的字段
+static int parseDocument(const QByteArray &body)
+{
+    // 模拟 readAll() 得到的完整副本
+    const QByteArray buffered(body.constData(), body.size());
+    const QJsonObject jsonObj = QJsonDocument::fromJson(buffered).object();
+    if (!jsonObj["success"].toBool()) {
+        return -1;
+    }
+
+    int found = 0;
+    const QJsonArray result = jsonObj["result"].toArray();
+    for (const QJsonValue &value : result) {
+        const QJsonObject recordInfo = value.toObject();
+        const QString name = recordInfo["name"].toString();
+        if (recordInfo["type"].toString() == "A" && !name.isEmpty()
+            && !recordInfo["id"].toString().isEmpty() && !recordInfo["content"].toString().isEmpty()
+            && recordInfo["ttl"].toInt() > 0) {
+            ++found;
+        }
+    }
+    return found;
+}
+
+static int parseStream(const QByteArray &body)
+{
+    int found = 0;
+    RecordListParser parser;
+    parser.setRecordHandler([&found](const RecordListParser::Record &record) {
+        if (record.type == "A" && !record.name.isEmpty() && !record.id.isEmpty()
+            && !record.content.isEmpty() && record.ttl > 0) {
+            ++found;
+        }
+    });
+
+    // 按网络层交付的大小分段输入
+    for (qsizetype offset = 0; offset < body.size(); offset += CHUNK_SIZE) {
+        const QByteArray chunk(body.constData() + offset, qMin<qsizetype>(CHUNK_SIZE, body.size() - offset));
+        parser.feed(chunk);
+    }
+    if (!parser.finish() || !parser.success()) {
+        return -1;
+    }
+    return found;
+}
+
+static BenchResult measure(const QString &name, int (*parse)(const QByteArray &),
+                           const QByteArray &body, const BenchOptions &options)
+{
+    qint64 totalNs = 0;
+    quint64 totalAllocations = 0;
+    qint64 transient = 0;
+    int found = 0;
+    for (int i = 0; i < options.iterations; ++i) {
+        AllocStats::resetPeak();
+        const qint64 before = AllocStats::liveBytes();
+        BenchScope scope;
+        found = parse(body);
+        totalNs += scope.elapsedNs();
+        totalAllocations += scope.allocations();
+        transient = qMax(transient, AllocStats::peakBytes() - before);
+    }
+    Q_ASSERT(found == options.records);
+    Q_UNUSED(found);
+
+    BenchResult result;
+    result.name = name;
+    result.add("records", options.records);
+    result.add("MB/s", body.size() / 1e6 / (totalNs / 1e9 / options.iterations));
+    if (AllocStats::isAvailable()) {
+        result.add("allocs/parse", double(totalAllocations) / options.iterations);
+        result.add("peak KB", transient / 1024.0);
+    }
+    result.add("ms/parse", totalNs / 1e6 / options.iterations);
+    return result;
+}
+
+QList<BenchResult> benchRecordList(const BenchOptions &options)
+{
+    const QByteArray body = listResponse(options.records);
+    return {
+        measure("recordlist/document", parseDocument, body, options),
+        measure("recordlist/stream", parseStream, body, options),
+    };
+}
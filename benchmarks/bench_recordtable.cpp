@@ -0,0 +1,140 @@
+#include "benchmark.h"
+#include "recordtable.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+
+// 与 Cloudflare 查询结果格式相同的模拟记录
+static QJsonArray searchResult(int count)
+{
+    QJsonArray result;
+    for (int i = 0; i < count; ++i) {
+        QJsonObject record;
+        record["id"] = QString("%1").arg(i, 32, 16, QLatin1Char('0'));
+        record["type"] = "A";
+        record["name"] = QString("host%1.example.com").arg(i);
+        record["content"] = QString("10.%1.%2.%3").arg((i >> 16) & 0xff).arg((i >> 8) & 0xff).arg(i & 0xff);
+        record["ttl"] = 300;
+        result.append(record);
+    }
+    return result;
+}
+
+// 原来的做法：查询结果按 "类型 名称" 保存 QJsonObject，记录ID另存一份 QString
+struct LegacyLayout
+{
+    QHash<QString, QList<QJsonObject>> existing;
+    QHash<QString, QString> recordIds;
+
+    void load(const QJsonArray &result)
+    {
+        existing.clear();
+        for (const QJsonValue &value : result) {
+            const QJsonObject recordInfo = value.toObject();
+            existing[QStringLiteral("A ") + recordInfo["name"].toString()].append(recordInfo);
+        }
+    }
+
+    int compare(const QJsonArray &result)
+    {
+        int unchanged = 0;
+        for (const QJsonValue &value : result) {
+            const QJsonObject desired = value.toObject();
+            const QString key = QStringLiteral("A ") + desired["name"].toString();
+            const QList<QJsonObject> matches = existing.value(key);
+            if (matches.size() != 1) {
+                continue;
+            }
+            recordIds[key] = matches.first()["id"].toString();
+            if (matches.first()["content"].toString() == desired["content"].toString()
+                && matches.first()["ttl"].toInt() == 300) {
+                ++unchanged;
+            }
+        }
+        return unchanged;
+    }
+};
+
+struct TableLayout
+{
+    RecordTable table;
+
+    void load(const QJsonArray &result)
+    {
+        table.resetSeen();
+        for (const QJsonValue &value : result) {
+            const QJsonObject recordInfo = value.toObject();
+            const int row = table.upsert("zone", "A", recordInfo["name"].toString());
+            if (!table.markSeen(row)) {
+                continue;
+            }
+            table.setRecordId(row, recordInfo["id"].toString());
+            table.setContent(row, recordInfo["content"].toString());
+            table.setTtl(row, quint32(recordInfo["ttl"].toInt()));
+        }
+    }
+
+    int compare(const QJsonArray &result)
+    {
+        int unchanged = 0;
+        for (const QJsonValue &value : result) {
+            const QJsonObject desired = value.toObject();
+            const int row = table.find("A", desired["name"].toString());
+            if (row == RecordTable::NoRow || table.isDuplicate(row)) {
+                continue;
+            }
+            if (table.contentEquals(row, desired["content"].toString()) && table.ttl(row) == 300) {
+                ++unchanged;
+            }
+        }
+        return unchanged;
+    }
+};
+
+// 常驻内存：建好后释放查询结果，剩下的就是布局本身占用的内存
+template<typename Layout>
+static void measure(const QString &name, const BenchOptions &options, QList<BenchResult> &results)
+{
+    BenchResult result;
+    result.name = name;
+
+    const qint64 baseline = AllocStats::liveBytes();
+    Layout layout;
+    {
+        const QJsonArray records = searchResult(options.records);
+        layout.load(records);
+    }
+    const qint64 resident = AllocStats::liveBytes() - baseline;
+
+    // 每轮：载入查询结果并与期望内容比较，不计生成模拟数据的开销
+    const QJsonArray records = searchResult(options.records);
+    qint64 totalNs = 0;
+    quint64 totalAllocations = 0;
+    int unchanged = 0;
+    for (int i = 0; i < options.iterations; ++i) {
+        BenchScope scope;
+        layout.load(records);
+        unchanged = layout.compare(records);
+        totalNs += scope.elapsedNs();
+        totalAllocations += scope.allocations();
+    }
+    Q_ASSERT(unchanged == options.records);
+    Q_UNUSED(unchanged);
+
+    result.add("records", options.records);
+    if (AllocStats::isAvailable()) {
+        result.add("bytes/record", double(resident) / options.records);
+        result.add("allocs/cycle", double(totalAllocations) / options.iterations);
+    }
+    result.add("ms/cycle", totalNs / 1e6 / options.iterations);
+    results.append(result);
+}
+
+QList<BenchResult> benchRecordTable(const BenchOptions &options)
+{
+    QList<BenchResult> results;
+    measure<LegacyLayout>("records/qjsonobject", options, results);
+    measure<TableLayout>("records/recordtable", options, results);
+    return results;
+}
@@ -0,0 +1,158 @@
+#include "benchmark.h"
+#include "recordlistparser.h"
+#include "cloudflareformat.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QUrl>
+
+static const QString ENDPOINT = "https://api.cloudflare.com/client/v4/";
+static const QString ZONE_ID = "023e105f4ecef8ad9ca31a8372d0c353";
+static const QString TOKEN = "tokenA0123456789abcdef0123456789abcdef";
+static const QString RECORD_ID = "372e67954025e0ba6aaa6d586b9e0b59";
+static const QString NAME = "home.example.com";
+
+static QString addressFor(int i)
+{
+    return QString("10.0.%1.%2").arg((i >> 8) & 0xff).arg(i & 0xff);
+}
+
+// 原来的做法：每次更新都格式化地址和认证头，并经 QJsonDocument 序列化记录
+static qint64 buildDocument(const QStringList &addresses, int ops)
+{
+    qint64 size = 0;
+    for (int i = 0; i < ops; ++i) {
+        QNetworkRequest request(QUrl(QString("https://api.cloudflare.com/client/v4/zones/%1/%2")
+                                         .arg(ZONE_ID, QString("dns_records/%1").arg(RECORD_ID))));
+        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+        request.setRawHeader("Authorization", QString("Bearer %1").arg(TOKEN).toUtf8());
+
+        QJsonObject data;
+        data["type"] = "A";
+        data["name"] = NAME;
+        data["content"] = addresses.at(i % addresses.size());
+        data["ttl"] = 300;
+        size += QJsonDocument(data).toJson(QJsonDocument::Compact).size();
+    }
+    return size;
+}
+
+// 与 Cloudflare::RecordPlan 相同：请求和正文前后缀预先生成，只补入地址
+struct Plan
+{
+    QNetworkRequest update;
+    QByteArray authHeader;
+    QByteArray bodyPrefix;
+    QByteArray bodySuffix;
+};
+
+static Plan compilePlan()
+{
+    Plan plan;
+    plan.update = CloudflareFormat::zoneRequest(ENDPOINT, ZONE_ID, QString("dns_records/%1").arg(RECORD_ID));
+    plan.authHeader = CloudflareFormat::authHeader(TOKEN);
+    plan.bodyPrefix = CloudflareFormat::bodyPrefix("A", NAME);
+    plan.bodySuffix = CloudflareFormat::bodySuffix(300);
+    return plan;
+}
+
+// 与 Cloudflare::send 和 appendRecordBody 相同：复制预编译的请求，补入认证头和地址
+static qint64 buildPlan(const Plan &plan, const QStringList &addresses, int ops)
+{
+    qint64 size = 0;
+    for (int i = 0; i < ops; ++i) {
+        QNetworkRequest request = plan.update;
+        request.setRawHeader("Authorization", plan.authHeader);
+
+        QByteArray body;
+        CloudflareFormat::appendBody(body, plan.bodyPrefix, addresses.at(i % addresses.size()), plan.bodySuffix);
+        size += body.size();
+    }
+    return size;
+}
+
+// PUT/POST 成功后返回的单条记录
+static QByteArray singleResponse()
+{
+    QJsonObject record;
+    record["id"] = RECORD_ID;
+    record["zone_id"] = ZONE_ID;
+    record["zone_name"] = "example.com";
+    record["name"] = NAME;
+    record["type"] = "A";
+    record["content"] = "203.0.113.45";
+    record["proxiable"] = true;
+    record["proxied"] = false;
+    record["ttl"] = 300;
+    record["meta"] = QJsonObject{{"auto_added", false}, {"source", "primary"}};
+    record["created_on"] = "2024-01-01T00:00:00.000000Z";
+    record["modified_on"] = "2024-01-01T00:00:00.000000Z";
+
+    QJsonObject body;
+    body["result"] = record;
+    body["success"] = true;
+    body["errors"] = QJsonArray();
+    body["messages"] = QJsonArray();
+    return QJsonDocument(body).toJson(QJsonDocument::Compact);
+}
+
+// 按名称精确查询的结果，只有一条记录
+static QByteArray searchResponse(const QByteArray &single)
+{
+    QJsonObject body = QJsonDocument::fromJson(single).object();
+    body["result"] = QJsonArray{body["result"]};
+    body["result_info"] = QJsonObject{{"page", 1}, {"per_page", 100}, {"count", 1},
+                                      {"total_count", 1}, {"total_pages", 1}};
+    return QJsonDocument(body).toJson(QJsonDocument::Compact);
+}
+
+QList<BenchResult> benchRequest(const BenchOptions &options)
+{
+    QStringList addresses;
+    for (int i = 0; i < 256; ++i) {
+        addresses.append(addressFor(i));
+    }
+    const Plan plan = compilePlan();
+
+    QList<BenchResult> results;
+    results.append(measureOps("request/document", options, 10000, [&addresses](int ops) {
+        return buildDocument(addresses, ops);
+    }));
+    results.append(measureOps("request/plan", options, 10000, [&plan, &addresses](int ops) {
+        return buildPlan(plan, addresses, ops);
+    }));
+
+    // handleCloudflareReply 使用的解析：解析整个文档后取出记录ID
+    const QByteArray single = singleResponse();
+    results.append(measureOps("response/single", options, 10000, [&single](int ops) {
+        qint64 found = 0;
+        QString recordId;
+        QString error;
+        for (int i = 0; i < ops; ++i) {
+            if (CloudflareFormat::parseRecordReply(single, recordId, error)) {
+                found += !recordId.isEmpty();
+            }
+        }
+        return found;
+    }));
+
+    // 单条记录的查询结果经流式解析器处理
+    const QByteArray search = searchResponse(single);
+    results.append(measureOps("response/search", options, 10000, [&search](int ops) {
+        qint64 found = 0;
+        RecordListParser parser;
+        parser.setRecordHandler([&found](const RecordListParser::Record &record) {
+            found += !record.id.isEmpty();
+        });
+        for (int i = 0; i < ops; ++i) {
+            parser.reset();
+            parser.feed(search);
+            parser.finish();
+        }
+        return found;
+    }));
+
+    return results;
+}
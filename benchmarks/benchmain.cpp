@@ -0,0 +1,118 @@
+#include "benchmark.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTextStream>
+
+// 新增基准在此登记
+static const QList<Benchmark> BENCHMARKS = {
+    {"records", benchRecordTable},
+    {"recordlist", benchRecordList},
+    {"config", benchConfig},
+    {"ip", benchIpParse},
+    {"request", benchRequest},
+};
+
+BenchResult measureOps(const QString &name, const BenchOptions &options, int ops, const std::function<qint64(int)> &run)
+{
+    // 预热一轮，排除首次调用的初始化开销
+    qint64 checksum = run(ops);
+
+    qint64 totalNs = 0;
+    quint64 totalAllocations = 0;
+    for (int i = 0; i < options.iterations; ++i) {
+        BenchScope scope;
+        checksum += run(ops);
+        totalNs += scope.elapsedNs();
+        totalAllocations += scope.allocations();
+    }
+    Q_UNUSED(checksum);
+
+    const double count = double(ops) * options.iterations;
+    BenchResult result;
+    result.name = name;
+    result.add("ns/op", totalNs / count);
+    if (AllocStats::isAvailable()) {
+        result.add("allocs/op", totalAllocations / count);
+    }
+    return result;
+}
+
+// 便于长期跟踪的 JSON 输出
+static QJsonObject toJson(const QList<BenchResult> &results, const BenchOptions &options)
+{
+    QJsonArray benchmarks;
+    for (const BenchResult &result : results) {
+        QJsonObject metrics;
+        for (const auto &metric : result.metrics) {
+            metrics[metric.first] = metric.second;
+        }
+        benchmarks.append(QJsonObject{{"name", result.name}, {"metrics", metrics}});
+    }
+
+    QJsonObject context;
+    context["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    context["qt_version"] = qVersion();
+    context["cpu_arch"] = QSysInfo::currentCpuArchitecture();
+    context["os"] = QSysInfo::prettyProductName();
+    context["records"] = options.records;
+    context["iterations"] = options.iterations;
+    context["alloc_stats"] = AllocStats::isAvailable();
+
+    return QJsonObject{{"context", context}, {"benchmarks", benchmarks}};
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ddns-qt micro benchmarks");
+    parser.addHelpOption();
+    QCommandLineOption filterOption("filter", "Only run benchmarks whose name contains <text>.", "text");
+    QCommandLineOption recordsOption("records", "Record count for table benchmarks (default 50000).", "count", "50000");
+    QCommandLineOption iterationsOption("iterations", "Repetitions per measurement (default 20).", "count", "20");
+    QCommandLineOption jsonOption("json", "Print the results as one JSON document.");
+    parser.addOptions({filterOption, recordsOption, iterationsOption, jsonOption});
+    parser.process(app);
+
+    BenchOptions options;
+    options.records = qMax(1, parser.value(recordsOption).toInt());
+    options.iterations = qMax(1, parser.value(iterationsOption).toInt());
+    const bool json = parser.isSet(jsonOption);
+
+    QTextStream out(stdout);
+    if (!AllocStats::isAvailable() && !json) {
+        out << "allocation statistics unavailable on this platform\n";
+    }
+
+    QList<BenchResult> all;
+    for (const Benchmark &benchmark : BENCHMARKS) {
+        if (parser.isSet(filterOption) && !benchmark.name.contains(parser.value(filterOption))) {
+            continue;
+        }
+        const QList<BenchResult> results = benchmark.run(options);
+        if (json) {
+            all.append(results);
+            continue;
+        }
+        for (const BenchResult &result : results) {
+            out << result.name;
+            for (const auto &metric : result.metrics) {
+                out << "  " << metric.first << "=" << QString::number(metric.second, 'f', 2);
+            }
+            out << "\n";
+        }
+        out.flush();
+    }
+
+    if (json) {
+        out << QJsonDocument(toJson(all, options)).toJson(QJsonDocument::Indented);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QElapsedTimer>
+#include <functional>
+
+// 基准运行参数
+struct BenchOptions
+{
+    // 记录表等按规模测量的基准使用的记录数
+    int records = 50000;
+    // 计时基准的重复次数
+    int iterations = 20;
+};
+
+// 一项测量结果，metrics 按输出顺序排列
+struct BenchResult
+{
+    QString name;
+    QList<QPair<QString, double>> metrics;
+
+    void add(const QString &metric, double value) { metrics.append({metric, value}); }
+};
+
+struct Benchmark
+{
+    QString name;
+    std::function<QList<BenchResult>(const BenchOptions &)> run;
+};
+
+// 堆分配统计，仅在 glibc 下可用
+namespace AllocStats {
+bool isAvailable();
+// 累计的分配次数（含 realloc）
+quint64 count();
+// 当前仍在使用的堆内存字节数
+qint64 liveBytes();
+// 自上次 resetPeak() 以来使用量的最大值
+qint64 peakBytes();
+void resetPeak();
+}
+
+// 一段代码执行期间的耗时和分配次数
+class BenchScope
+{
+public:
+    BenchScope() : allocations_(AllocStats::count()) { timer_.start(); }
+
+    qint64 elapsedNs() const { return timer_.nsecsElapsed(); }
+    quint64 allocations() const { return AllocStats::count() - allocations_; }
+
+private:
+    QElapsedTimer timer_;
+    quint64 allocations_;
+};
+
+// 重复 options.iterations 轮，每轮调用一次 run(ops)，按单次操作报告耗时和分配次数
+// run 返回任意校验值，避免被优化掉
+BenchResult measureOps(const QString &name, const BenchOptions &options, int ops, const std::function<qint64(int)> &run);
+
+QList<BenchResult> benchRecordTable(const BenchOptions &options);
+QList<BenchResult> benchRecordList(const BenchOptions &options);
+QList<BenchResult> benchConfig(const BenchOptions &options);
+QList<BenchResult> benchIpParse(const BenchOptions &options);
+QList<BenchResult> benchRequest(const BenchOptions &options);
+
+#endif // BENCHMARK_H
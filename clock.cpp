@@ -0,0 +1,37 @@
+#include "clock.h"
+
+#include <QElapsedTimer>
+
+static bool virtualMode = false;
+static qint64 virtualNow = 0;
+
+static const QElapsedTimer &realClock()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+    return clock;
+}
+
+qint64 Clock::elapsed()
+{
+    return virtualMode ? virtualNow : realClock().elapsed();
+}
+
+void Clock::setVirtual(qint64 start)
+{
+    virtualMode = true;
+    virtualNow = start;
+}
+
+bool Clock::isVirtual()
+{
+    return virtualMode;
+}
+
+void Clock::setVirtualTime(qint64 msec)
+{
+    // 时间只能向前
+    virtualNow = qMax(virtualNow, msec);
+}
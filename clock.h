@@ -0,0 +1,17 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <QtGlobal>
+
+// 单调时钟（毫秒），调度相关的计时统一使用；模拟模式下改为由外部推进的虚拟时间
+class Clock
+{
+public:
+    static qint64 elapsed();
+
+    static void setVirtual(qint64 start = 0);
+    static bool isVirtual();
+    static void setVirtualTime(qint64 msec);
+};
+
+#endif // CLOCK_H
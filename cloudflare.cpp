@@ -2,363 +2,487 @@
 #include "common.h"
 
 #include <QJsonDocument>
-#include <QMessageBox>
 #include <QObject>
 #include <QJsonArray>
-#include <QThread>
-#include <QTimer>
+#include <QSet>
 #include <QSharedPointer>
 
-void Cloudflare::updateDnsRecord(const QLineEdit *cfApiKey, const QLineEdit *cfZoneId, const QLineEdit *cfDomain,
-                                  const QString &ipv4, const QString &ipv6,
-                                  const QLineEdit *ipv4RecordName, const QLineEdit *ipv6RecordName)
+// 按类型列出记录时单页上限，覆盖一次前缀委派产生的全部记录
+static const int LIST_PAGE_SIZE = 5000;
+static const QString DEFAULT_ENDPOINT = "https://api.cloudflare.com/client/v4/";
+
+bool Cloudflare::loadConfig(const QJsonObject &config, QString &error)
 {
-    // 获取配置
-    apiKey_ = "Bearer " + cfApiKey->text();
-    zoneId_ = cfZoneId->text();
-    domain_ = cfDomain->text();
-    QString ipv4Record = ipv4RecordName->text();
-    QString ipv6Record = ipv6RecordName->text();
+    QString zoneId = config["zone_id"].toString();
+    QString domain = config["domain"].toString();
+    // endpoint 可指向本地模拟服务器
+    QString endpoint = config["endpoint"].toString(DEFAULT_ENDPOINT);
 
-    // 检查记录名称
-    if (!ipv4.isEmpty() && ipv4RecordName->text().isEmpty()) {
-        QMessageBox::warning(this, "Configuration Error", "Please specify IPv4 record name");
-        return;
+    // api_key 与 api_tokens 中的令牌共同组成令牌池
+    tokens_.loadConfig(config["api_key"].toString(), config["api_tokens"].toArray());
+
+    if (tokens_.isEmpty() || zoneId.isEmpty() || domain.isEmpty()) {
+        error = "Please fill in all Cloudflare settings";
+        return false;
     }
-    if (!ipv6.isEmpty() && ipv6RecordName->text().isEmpty()) {
-        QMessageBox::warning(this, "Configuration Error", "Please specify IPv6 record name");
-        return;
+
+    // 区域、域名或接口地址变化后，缓存的记录ID和请求计划失效
+    if (zoneId != zoneId_ || domain != domain_ || endpoint != endpoint_) {
+        table_.clear();
+        plans_.clear();
+        zoneId_ = zoneId;
+        domain_ = domain;
+        endpoint_ = endpoint;
+        compileZoneRequests();
     }
 
-    connect(this, &Cloudflare::searchComplete, this, &Cloudflare::updateCloudflareDns);
+    // 各令牌的认证头只在加载配置时编码一次
+    authHeaders_.clear();
+    for (int i = 0; i < tokens_.size(); ++i) {
+        authHeaders_.append(CloudflareFormat::authHeader(tokens_.token(i).token));
+    }
+    return true;
+}
 
-    qInfo("start update dns record");
-    qInfo() << QString("ipv4: %1").arg(ipv4);
-    qInfo() << QString("ipv6: %1").arg(ipv6);
+QNetworkRequest Cloudflare::zoneRequest(const QString &path) const
+{
+    return CloudflareFormat::zoneRequest(endpoint_, zoneId_, path);
+}
 
-    // 更新IPv4记录
-    if (!ipv4.isEmpty()) {
-        ipv4_data_["type"] = "A";
-        ipv4_data_["name"] = ipv4Record + "." + domain_;
-        ipv4_data_["content"] = ipv4;
-        if(ipv4RecordId_.isEmpty()) {
-            searchCloudflareRecordId(true);
-        }
+void Cloudflare::compileZoneRequests()
+{
+    createRequest_ = zoneRequest("dns_records");
+    batchRequest_ = zoneRequest("dns_records/batch");
+
+    listRequests_.clear();
+    for (const QString &type : {QStringLiteral("A"), QStringLiteral("AAAA")}) {
+        listRequests_.insert(type, zoneRequest(QString("dns_records?type=%1&per_page=%2").arg(type).arg(LIST_PAGE_SIZE)));
     }
+}
 
-    // 更新IPv6记录
-    if (!ipv6.isEmpty()) {
-        ipv6_data_["type"] = "AAAA";
-        ipv6_data_["name"] = ipv6Record + "." + domain_;
-        ipv6_data_["content"] = ipv6;
+Cloudflare::RecordPlan &Cloudflare::plan(int row)
+{
+    if (plans_.size() < table_.size()) {
+        plans_.resize(table_.size());
+    }
+    RecordPlan &plan = plans_[row];
+
+    // 记录名不变的部分只生成一次
+    if (plan.bodyPrefix.isEmpty()) {
+        const QString type = table_.type(row);
+        const QString name = table_.name(row);
+        plan.search = zoneRequest(QString("dns_records?type=%1&name=%2").arg(type, name));
+        plan.bodyPrefix = CloudflareFormat::bodyPrefix(type, name);
+    }
 
-        if(ipv6RecordId_.isEmpty()) {
-            searchCloudflareRecordId(false);
-        }
+    // TTL 由动态 TTL 策略决定，变化时重建结尾
+    if (plan.bodySuffix.isEmpty() || plan.ttl != ttl_) {
+        plan.bodySuffix = CloudflareFormat::bodySuffix(ttl_);
+        plan.ttl = ttl_;
+    }
+
+    if (plan.recordId.isEmpty() && table_.hasRecordId(row)) {
+        plan.recordId = table_.recordId(row);
+        plan.update = zoneRequest(QString("dns_records/%1").arg(plan.recordId));
+        plan.patchPrefix = CloudflareFormat::patchPrefix(plan.recordId, plan.bodyPrefix);
     }
+    return plan;
 }
 
-void Cloudflare::searchCloudflareRecordId(bool isIpv4)
+void Cloudflare::setRecordId(int row, const QString &recordId)
 {
-    QString name = isIpv4 ? ipv4_data_["name"].toString() : ipv6_data_["name"].toString();
-    QNetworkRequest request(QUrl(QString("https://api.cloudflare.com/client/v4/zones/%1/dns_records?name=%2")
-                                     .arg(zoneId_)
-                                     .arg(name)));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", apiKey_.toUtf8());
-
-    QNetworkReply *reply = networkManager_->get(request);
-
-    // 添加超时处理
-    QTimer::singleShot(30000, reply, [reply]() {
-        if (reply && reply->isRunning()) {
-            qWarning("search time out");
-            reply->abort();
-            reply->deleteLater();
-        }
-    });
+    // ID 变化时修改请求需要重建
+    if (row < plans_.size() && plans_.at(row).recordId != recordId) {
+        plans_[row].recordId.clear();
+    }
+    if (recordId.isEmpty()) {
+        table_.clearRecordId(row);
+    } else {
+        table_.setRecordId(row, recordId);
+    }
+}
 
-    qDebug("search in connect");
+void Cloudflare::appendRecordBody(QByteArray &body, int index, bool withId)
+{
+    const RecordPlan &recordPlan = plan(rows_.at(index));
+    CloudflareFormat::appendBody(body, withId ? recordPlan.patchPrefix : recordPlan.bodyPrefix,
+                                 records_.at(index).content, recordPlan.bodySuffix);
+}
+
+void Cloudflare::send(const QByteArray &verb, const QNetworkRequest &request, const QByteArray &data,
+                      ReplyHandler done, ReplyHandler attach, bool streamed, bool retried)
+{
+    const int token = tokens_.acquire(zoneId_);
+    if (token < 0) {
+        // 不发出不带认证的请求，直接以错误结束
+        ManagedReply *reply = trackReply(requestManager_->failed(
+            request.url(), QNetworkReply::AuthenticationRequiredError,
+            QString("No usable API token for zone %1: %2").arg(zoneId_, tokens_.describe())));
+        connect(reply, &ManagedReply::finished, this, [reply, done]() { done(reply); });
+        return;
+    }
 
-    connect(reply, &QNetworkReply::errorOccurred, reply, [this, reply](QNetworkReply::NetworkError error) {
-        qCritical() << QString("error: %1").arg(error);
-        reply->deleteLater();
+    QNetworkRequest authorized = request;
+    authorized.setRawHeader("Authorization", authHeaders_.at(token));
+
+    ManagedReply *reply = nullptr;
+    if (verb == "GET") {
+        reply = streamed ? requestManager_->getStreamed(authorized) : requestManager_->get(authorized);
+    } else if (verb == "POST") {
+        reply = requestManager_->post(authorized, data);
+    } else if (verb == "PUT") {
+        reply = requestManager_->put(authorized, data);
+    } else {
+        reply = requestManager_->deleteResource(authorized);
+    }
+    trackReply(reply);
+    if (attach) {
+        attach(reply);
+    }
+
+    connect(reply, &ManagedReply::errorOccurred, reply, [](QNetworkReply::NetworkError error) {
+        qWarning() << QString("error: %1").arg(error);
     });
 
-    reply->setParent(this);
-    connect(reply, &QNetworkReply::finished, this, [this, reply, isIpv4]() {
-        reply->deleteLater();
+    // 先更新令牌状态再交给调用方，使本轮后续请求不再分配到失效的令牌
+    connect(reply, &ManagedReply::finished, this,
+            [this, reply, token, verb, request, data, done, attach, streamed, retried]() {
+        const int status = reply->httpStatus();
+        if (status == 401 || status == 403) {
+            tokens_.isolate(token, QString("HTTP %1 for zone %2").arg(status).arg(zoneId_));
+            // 令牌可能只是缺少该区域的权限，换一个令牌重试一次
+            if (!retried && !isStale(reply) && tokens_.usableCount(zoneId_) > 0) {
+                qInfo() << QString("retry with another API token: %1").arg(reply->url().toString(QUrl::RemoveQuery));
+                send(verb, request, data, done, attach, streamed, true);
+                return;
+            }
+        } else if (status == 429) {
+            tokens_.exhaust(token);
+        } else if (status >= 200 && status < 300) {
+            tokens_.confirm(token);
+        }
+        done(reply);
+    });
+}
 
-        if (reply->error() != QNetworkReply::NoError) {
-            QMessageBox::warning(this, "DDNS Update Error",
-                                 QString("Search record ID error: %1")
-                                     .arg(reply->errorString()));
-            emit searchComplete(isIpv4);
+void Cloudflare::updateDnsRecords(const QList<DnsRecord> &records)
+{
+    // 检查记录名称
+    for (const DnsRecord &record : records) {
+        if (record.name.isEmpty()) {
+            emit updateFinished(false, QString("Please specify %1 record name").arg(record.type == "A" ? "IPv4" : "IPv6"));
             return;
         }
+    }
 
-        QJsonParseError jsonError;
-        QByteArray data = reply->readAll();
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &jsonError);
+    if (tokens_.usableCount(zoneId_) == 0) {
+        emit updateFinished(false, QString("No usable API token for zone %1: %2").arg(zoneId_, tokens_.describe()));
+        return;
+    }
 
-        if (jsonError.error != QJsonParseError::NoError) {
-            QMessageBox::warning(this, "DDNS Update Error",
-                                 QString("JSON parse error: %1")
-                                     .arg(jsonError.error));
+    qInfo() << QString("start update %1 dns record(s)").arg(records.size());
+
+    records_.clear();
+    rows_.clear();
+    errors_.clear();
+    unchanged_ = 0;
+    table_.resetSeen();
+
+    QSet<QString> types;
+    for (DnsRecord record : records) {
+        record.name = record.name + "." + domain_;
+        qInfo() << QString("%1 %2: %3").arg(record.type, record.name, record.content);
+        records_.append(record);
+        rows_.append(table_.upsert(zoneId_, record.type, record.name));
+        types.insert(record.type);
+    }
 
-            emit searchComplete(isIpv4);
-            return;
+    if (records_.isEmpty()) {
+        emit updateFinished(true, "nothing to update");
+        return;
+    }
+
+    // 每种类型一次查询，查询全部完成后合并为一次写入
+    pending_ = types.size();
+    for (const QString &type : std::as_const(types)) {
+        searchCloudflareRecords(type);
+    }
+}
+
+void Cloudflare::finishUpdate(bool success, const QString &message)
+{
+    QStringList messages = errors_;
+    if (!message.isEmpty()) {
+        messages.prepend(message);
+    }
+    emit updateFinished(success && errors_.isEmpty(), messages.join("; "));
+}
+
+void Cloudflare::searchCloudflareRecords(const QString &type, int page)
+{
+    int count = 0;
+    int row = RecordTable::NoRow;
+    for (int i = 0; i < records_.size(); ++i) {
+        if (records_.at(i).type == type) {
+            ++count;
+            row = rows_.at(i);
         }
+    }
 
-        QJsonObject jsonObj = jsonDoc.object();
-        if (!jsonObj["success"].toBool()) {
-            QString errorMsg = jsonObj["errors"].toArray().first().toObject()["message"].toString();
-            QMessageBox::warning(this, "DDNS Update Error",
-                                 QString("Search record ID error: %1")
-                                     .arg(errorMsg));
-            emit searchComplete(isIpv4);
+    // 只有一条时按名称精确查询，多条时列出该类型的全部记录
+    QNetworkRequest request;
+    if (count == 1) {
+        request = plan(row).search;
+    } else if (page == 1) {
+        request = listRequests_.value(type);
+    } else {
+        request = zoneRequest(QString("dns_records?type=%1&per_page=%2&page=%3").arg(type).arg(LIST_PAGE_SIZE).arg(page));
+    }
+
+    // 列表可能很大，边接收边解析，只保留本轮要写入的记录
+    QSharedPointer<RecordListParser> parser(new RecordListParser);
+    parser->setRecordHandler([this, type](const RecordListParser::Record &recordInfo) {
+        const int row = table_.find(type, QString::fromUtf8(recordInfo.name));
+        if (row == RecordTable::NoRow || !table_.markSeen(row)) {
             return;
         }
+        setRecordId(row, QString::fromLatin1(recordInfo.id));
+        table_.setContent(row, QString::fromLatin1(recordInfo.content));
+        table_.setTtl(row, quint32(recordInfo.ttl));
+    });
 
-        QJsonArray result = jsonObj["result"].toArray();
-        if(result.size() != 1) {
-            QMessageBox::warning(this, "DDNS Update Error",
-                                 QString("Record ID count is not equal to 1"));
-            emit searchComplete(isIpv4);
+    // 换令牌重试时丢弃上一次收到的错误响应
+    auto attach = [this, parser](ManagedReply *reply) {
+        parser->reset();
+        connect(reply, &ManagedReply::dataReceived, this, [this, reply, parser](const QByteArray &chunk) {
+            if (!isStale(reply)) {
+                parser->feed(chunk);
+            }
+        });
+    };
+
+    send("GET", request, QByteArray(), [this, type, page, parser](ManagedReply *reply) {
+        if (isStale(reply)) {
             return;
         }
 
-        QJsonObject recordInfo = result.at(0).toObject();
-        QString recordId = recordInfo["id"].toString();
-        QString recordType = recordInfo["type"].toString();
-
-        // 使用 QMetaObject::invokeMethod 确保在主线程中更新成员变量
-        if (!recordId.isEmpty() && !recordType.isEmpty()) {
-            QMetaObject::invokeMethod(this, [this, recordId, recordType, isIpv4]() {
-                if(recordType == "A") {
-                    ipv4RecordId_ = recordId;
-                }
-                else if(recordType == "AAAA") {
-                    ipv6RecordId_ = recordId;
-                }
-                emit searchComplete(isIpv4);
-            }, Qt::QueuedConnection);
+        const bool complete = parser->finish();
+        if (reply->error() != QNetworkReply::NoError) {
+            errors_.append(QString("Search %1 records error: %2").arg(type, reply->errorString()));
+        } else if (!complete) {
+            errors_.append(QString("JSON parse error in %1 record list").arg(type));
+        } else if (!parser->success()) {
+            errors_.append(QString("Search %1 records error: %2").arg(type, parser->firstError()));
+        } else {
+            qInfo() << QString("search cf %1 records page %2/%3 done, %4 found")
+                           .arg(type)
+                           .arg(page)
+                           .arg(parser->totalPages())
+                           .arg(parser->recordCount());
+
+            // 还有下一页时继续查询，本类型的查询尚未完成
+            if (page < parser->totalPages()) {
+                searchCloudflareRecords(type, page + 1);
+                return;
+            }
         }
-        qInfo("search cf record id done");
-    });
+
+        if (--pending_ > 0) {
+            return;
+        }
+        if (!errors_.isEmpty()) {
+            finishUpdate(false, QString());
+            return;
+        }
+        applyChanges();
+    }, attach, true);
 }
 
-// TODO 待测试
-void Cloudflare::deleteDnsRecord(bool isIpv4)
+void Cloudflare::applyChanges()
 {
-    QString recordId = QString();
-    if(isIpv4) {
-        recordId = ipv4RecordId_;
-    } else {
-        recordId = ipv6RecordId_;
-    }
-
-    QNetworkRequest request(QUrl(QString("https://api.cloudflare.com/client/v4/zones/%1/dns_records/%2")
-                                     .arg(zoneId_)
-                                     .arg(recordId)));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", apiKey_.toUtf8());
-
-    QNetworkReply *reply = networkManager_->deleteResource(request);
-    connect(reply, &QNetworkReply::errorOccurred, reply, [this, reply](QNetworkReply::NetworkError error) {
-        qCritical() << QString("error: %1").arg(error);
-        reply->deleteLater();
-    });
+    QList<int> patches;
+    QList<int> posts;
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply, recordId]() {
-        reply->deleteLater();
+    for (int i = 0; i < records_.size(); ++i) {
+        const DnsRecord &record = records_.at(i);
+        const int row = rows_.at(i);
 
-        QJsonParseError jsonError;
-        QByteArray data = reply->readAll();
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &jsonError);
-        if (jsonError.error != QJsonParseError::NoError) {
-            QMessageBox::warning(this, "DDNS Delete Error",
-                                 QString("JSON parse error: %1")
-                                     .arg(jsonError.error));
+        if (table_.isDuplicate(row)) {
+            errors_.append(QString("%1: Record ID count is not equal to 1").arg(record.name));
+            continue;
+        }
 
-            return;
+        if (!table_.isSeen(row)) {
+            setRecordId(row, QString());
+            posts.append(i);
+            continue;
         }
-        QJsonObject jsonObj = jsonDoc.object();
-        QJsonObject result = jsonObj["result"].toObject();
-        if(result["id"] != recordId) {
-            QMessageBox::warning(this, "DDNS Delete Error",
-                                 QString("cf call return id not matched!"));
 
-            return ;
+        // 查询结果已包含记录内容，无需再次获取
+        // TTL 不一致时也需要更新（动态 TTL 调整）
+        if (table_.contentEquals(row, record.content) && table_.ttl(row) == quint32(ttl_)) {
+            ++unchanged_;
+            continue;
         }
-    });
-}
+        patches.append(i);
+    }
 
-void Cloudflare::checkIpRecordMatch(bool isIpv4)
-{
-    QString recordId = QString();
-    if(isIpv4) {
-        recordId = ipv4RecordId_;
-    } else {
-        recordId = ipv6RecordId_;
+    const int changes = patches.size() + posts.size();
+    if (changes == 0) {
+        qInfo("IP Record matched, not update.");
+        finishUpdate(true, QString("%1 record(s) unchanged").arg(unchanged_));
+        return;
     }
-    QNetworkRequest request(QUrl(QString("https://api.cloudflare.com/client/v4/zones/%1/dns_records/%2")
-                                     .arg(zoneId_)
-                                     .arg(recordId)));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", apiKey_.toUtf8());
-
-    QNetworkReply *reply = networkManager_->get(request);
-    connect(reply, &QNetworkReply::errorOccurred, reply, [this, reply](QNetworkReply::NetworkError error) {
-        qCritical() << QString("error: %1").arg(error);
-        reply->deleteLater();
-    });
 
-    connect(this, &Cloudflare::IpRecordNotMatch, this, &Cloudflare::updateExistRecord);
+    // 单条变化沿用单记录接口，多条合并为一次批量请求
+    if (changes > 1) {
+        batchUpdate(patches, posts);
+    } else if (posts.isEmpty()) {
+        updateExistRecord(patches.first());
+    } else {
+        createNewRecord(posts.first());
+    }
+}
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply, isIpv4]() {
-        reply->deleteLater();
+// TODO 待测试
+void Cloudflare::deleteDnsRecord(const QString &type, const QString &name)
+{
+    const int row = table_.find(type, name + "." + domain_);
+    if (row == RecordTable::NoRow || !table_.hasRecordId(row)) {
+        qWarning() << QString("DDNS delete error, no cached record ID for %1 %2").arg(type, name);
+        return;
+    }
 
+    const RecordPlan &recordPlan = plan(row);
+    const QString recordId = recordPlan.recordId;
+    send("DELETE", recordPlan.update, QByteArray(), [recordId](ManagedReply *reply) {
         QJsonParseError jsonError;
         QByteArray data = reply->readAll();
         QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &jsonError);
-
         if (jsonError.error != QJsonParseError::NoError) {
-            QMessageBox::warning(this, "DDNS Check Error",
-                                 QString("JSON parse error: %1")
-                                     .arg(jsonError.error));
-
+            qWarning() << QString("DDNS delete error, JSON parse error: %1").arg(jsonError.errorString());
             return;
         }
-
         QJsonObject jsonObj = jsonDoc.object();
-        if (!jsonObj["success"].toBool()) {
-            QString errorMsg = jsonObj["errors"].toArray().first().toObject()["message"].toString();
-            QMessageBox::warning(this, "DDNS Check Error",
-                                 QString("cloudflare call fails: %1")
-                                     .arg(errorMsg));
-            return;
-        }
-
         QJsonObject result = jsonObj["result"].toObject();
-        QString ip_content = isIpv4 ? ipv4_data_["content"].toString() : ipv6_data_["content"].toString();
-
-        qDebug() << QString("call return: %1").arg(result["content"].toString());
-        qDebug() << QString("ip_content: %1").arg(ip_content);
-        if(result["content"].toString() != ip_content) {
-            emit IpRecordNotMatch(isIpv4);
+        if(result["id"] != recordId) {
+            qWarning("DDNS delete error, cf call return id not matched!");
             return ;
         }
-
-        qInfo("IP Record matched, not update.");
     });
 }
 
-void Cloudflare::createNewRecord(bool isIpv4)
+void Cloudflare::createNewRecord(int index)
 {
     // 创建新记录
     qInfo("no record, create new");
-    QNetworkRequest request(QUrl(QString("https://api.cloudflare.com/client/v4/zones/%1/dns_records").arg(zoneId_)));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", apiKey_.toUtf8());
-
-    QJsonObject data = isIpv4 ? ipv4_data_ : ipv6_data_;
-    QJsonDocument jsonDoc(data);
-    QByteArray jsonData = jsonDoc.toJson();
-
-    QNetworkReply *reply = networkManager_->post(request, jsonData);
-    reply->setParent(this);
-    connect(reply, &QNetworkReply::finished, this, [this, reply, isIpv4]() {
-        handleCloudflareReply(reply, isIpv4);
+    QByteArray jsonData;
+    appendRecordBody(jsonData, index, false);
+
+    send("POST", createRequest_, jsonData, [this, index](ManagedReply *reply) {
+        if (isStale(reply)) {
+            return;
+        }
+        handleCloudflareReply(reply, index);
     });
 }
 
-void Cloudflare::updateExistRecord(bool isIpv4)
+void Cloudflare::updateExistRecord(int index)
 {
-    QNetworkRequest request(QUrl(QString("https://api.cloudflare.com/client/v4/zones/%1/dns_records").arg(zoneId_)));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", apiKey_.toUtf8());
-
-    QJsonObject data = isIpv4 ? ipv4_data_ : ipv6_data_;
-    QJsonDocument jsonDoc(data);
-    QByteArray jsonData = jsonDoc.toJson();
+    QByteArray jsonData;
+    appendRecordBody(jsonData, index, false);
 
-    QString recordId = isIpv4 ? ipv4RecordId_ : ipv6RecordId_;
     // 更新现有记录
-    QUrl updateUrl(QString("https://api.cloudflare.com/client/v4/zones/%1/dns_records/%2")
-                       .arg(zoneId_).arg(recordId));
-    QNetworkRequest updateRequest(updateUrl);
-    updateRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    updateRequest.setRawHeader("Authorization", apiKey_.toUtf8());
-
     qInfo("start update dns");
-    qDebug() << QString("start request: %1").arg(updateUrl.toString());
-
-    QNetworkReply *reply = networkManager_->put(updateRequest, jsonData);
-
-    connect(reply, &QNetworkReply::errorOccurred, reply, [this, reply](QNetworkReply::NetworkError error) {
-        qWarning() <<  QString("error: %1").arg(error);
-        reply->deleteLater();
-    });
-
-    connect(reply, &QNetworkReply::finished, this, [this, reply, isIpv4]() {
-        handleCloudflareReply(reply, isIpv4);
-        reply->deleteLater();
+    const QNetworkRequest &request = plan(rows_.at(index)).update;
+    qDebug() << QString("start request: %1").arg(request.url().toString());
+    send("PUT", request, jsonData, [this, index](ManagedReply *reply) {
+        if (isStale(reply)) {
+            return;
+        }
+        handleCloudflareReply(reply, index);
     });
 }
 
-void Cloudflare::updateCloudflareDns(bool isIpv4)
+void Cloudflare::batchUpdate(const QList<int> &patches, const QList<int> &posts)
 {
-    qInfo( "start update cloudflare dns" );
-    QString recordId = isIpv4 ? ipv4RecordId_ : ipv6RecordId_;
-    qDebug() << QString("recordID: %1").arg(recordId);
+    // 由各记录的请求计划拼接，不经过 QJsonDocument
+    QByteArray jsonData = "{\"patches\":[";
+    for (int i = 0; i < patches.size(); ++i) {
+        if (i > 0) {
+            jsonData.append(',');
+        }
+        appendRecordBody(jsonData, patches.at(i), true);
+    }
+    jsonData.append("],\"posts\":[");
+    for (int i = 0; i < posts.size(); ++i) {
+        if (i > 0) {
+            jsonData.append(',');
+        }
+        appendRecordBody(jsonData, posts.at(i), false);
+    }
+    jsonData.append("]}");
 
-    connect(this, &Cloudflare::IpRecordExist, this, &Cloudflare::checkIpRecordMatch);
+    qInfo() << QString("start batch update: %1 updated, %2 created").arg(patches.size()).arg(posts.size());
 
-    if (recordId.isEmpty()) {
-        createNewRecord(isIpv4);
-    } else {
-        qInfo() << "record exist.";
-        emit IpRecordExist(isIpv4);
-    }
+    const int updated = patches.size();
+    const int created = posts.size();
+    send("POST", batchRequest_, jsonData, [this, updated, created](ManagedReply *reply) {
+        if (isStale(reply)) {
+            return;
+        }
+
+        if (reply->error() != QNetworkReply::NoError) {
+            finishUpdate(false, QString("batch update failed: %1").arg(reply->errorString()));
+            return;
+        }
+
+        QJsonObject jsonObj = QJsonDocument::fromJson(reply->readAll()).object();
+        if (!jsonObj["success"].toBool()) {
+            finishUpdate(false, QString("batch update failed: %1").arg(CloudflareFormat::firstError(jsonObj)));
+            return;
+        }
+
+        // 批量请求是原子的，成功即全部生效
+        for (int i = 0; i < records_.size(); ++i) {
+            table_.setContent(rows_.at(i), records_.at(i).content);
+            table_.setTtl(rows_.at(i), quint32(ttl_));
+        }
+        const QJsonArray posted = jsonObj["result"].toObject()["posts"].toArray();
+        for (const QJsonValue &value : posted) {
+            const QJsonObject recordInfo = value.toObject();
+            const int row = table_.find(recordInfo["type"].toString(), recordInfo["name"].toString());
+            if (row != RecordTable::NoRow) {
+                setRecordId(row, recordInfo["id"].toString());
+            }
+        }
+
+        finishUpdate(true, QString("updated %1, created %2, unchanged %3").arg(updated).arg(created).arg(unchanged_));
+    });
 }
 
-void Cloudflare::handleCloudflareReply(QNetworkReply *reply, bool isIPv4)
+void Cloudflare::handleCloudflareReply(ManagedReply *reply, int index)
 {
-    if (reply->error() == QNetworkReply::NoError) {
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObj = jsonDoc.object();
+    const DnsRecord &record = records_.at(index);
+    const int row = rows_.at(index);
 
-        if (jsonObj["success"].toBool()) {
-            QJsonObject result = jsonObj["result"].toObject();
-            QString recordId = result["id"].toString();
-            if (!recordId.isEmpty()) {
-                QMetaObject::invokeMethod(this, [this, recordId, isIPv4]() {
-                    if(isIPv4) {
-                        ipv4RecordId_ = recordId;
-                        qDebug() << QString("Updated IPv4 record ID: %1").arg(recordId);
-                    }
-                    else {
-                        ipv6RecordId_ = recordId;
-                        qDebug() << QString("Updated IPv6 record ID: %1").arg(recordId);
-                    }
-                }, Qt::QueuedConnection);
-            }
+    if (reply->error() != QNetworkReply::NoError) {
+        finishUpdate(false, QString("record update failed: %1").arg(reply->errorString()));
+        return;
+    }
 
-            QString recordType = isIPv4 ? "IPv4 (A)" : "IPv6 (AAAA)";
-            QMessageBox::information(this, "DDNS Update Success",
-                                     recordType + " record updated successfully");
-        } else {
-            QString errorMsg = jsonObj["errors"].toString();
-            QMessageBox::warning(this, "DDNS Update Error",
-                                 QString("%1 record update failed: %2")
-                                     .arg(isIPv4 ? "IPv4" : "IPv6")
-                                     .arg(errorMsg));
-        }
-    } else {
-        QMessageBox::warning(this, "DDNS Update Error",
-                             QString("%1 record update failed: %2")
-                                 .arg(isIPv4 ? "IPv4" : "IPv6")
-                                 .arg(reply->errorString()));
+    QString recordId;
+    QString error;
+    if (!CloudflareFormat::parseRecordReply(reply->readAll(), recordId, error)) {
+        finishUpdate(false, QString("record update failed: %1").arg(error));
+        return;
+    }
+
+    if (!recordId.isEmpty()) {
+        setRecordId(row, recordId);
+        qDebug() << QString("Updated %1 %2 record ID: %3").arg(record.type, record.name, recordId);
     }
+    table_.setContent(row, record.content);
+    table_.setTtl(row, quint32(ttl_));
+    finishUpdate(true, QString("%1 %2: updated").arg(record.type, record.name));
 }
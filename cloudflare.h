@@ -1,52 +1,98 @@
 #ifndef CLOUDFLARE_H
 #define CLOUDFLARE_H
 
-#include <QWidget>
 #include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
 #include <QJsonObject>
-#include <QNetworkReply>
-#include <QLineEdit>
+#include <QJsonArray>
+#include <QNetworkRequest>
 
-class Cloudflare : public QWidget
+#include "dnsprovider.h"
+#include "tokenpool.h"
+#include "recordtable.h"
+#include "recordlistparser.h"
+#include "cloudflareformat.h"
+
+class Cloudflare : public DnsProvider
 {
     Q_OBJECT
 public:
-    Cloudflare(QNetworkAccessManager *networkManager) : networkManager_(networkManager) {};
+    Cloudflare(RequestManager *requestManager) : DnsProvider(requestManager) {};
+
+    QString name() const override { return "Cloudflare"; }
+    bool loadConfig(const QJsonObject &config, QString &error) override;
 
+    void updateDnsRecords(const QList<DnsRecord> &records) override;
 
-    void updateDnsRecord(const QLineEdit *cfApiKey, const QLineEdit *cfZoneId, const QLineEdit *cfDomain,
-                          const QString &ipv4, const QString &ipv6,
-                          const QLineEdit *ipv4RecordName, const QLineEdit *ipv6RecordName);
+    void deleteDnsRecord(const QString &type, const QString &name);
 
-    void deleteDnsRecord(bool isIpv4);
+    const TokenPool &tokenPool() const { return tokens_; }
 
 private:
-    void checkIpRecordMatch(bool isIpv4);
-    void createNewRecord(bool isIpv4);
-    void updateExistRecord(bool isIpv4);
-    void handleCloudflareReply(QNetworkReply *reply, bool isIPv4);
-    void searchCloudflareRecordId(bool isIpv4);
+    // 按记录预先生成的请求，只有 content 在发送时补入
+    struct RecordPlan
+    {
+        // 按名称精确查询
+        QNetworkRequest search;
+        // PUT/DELETE dns_records/<id>，记录ID已知后生成
+        QNetworkRequest update;
+        QString recordId;
+        // {"name":...,"type":...,"content":"  和带 id 的批量修改版本
+        QByteArray bodyPrefix;
+        QByteArray patchPrefix;
+        // ","ttl":N}
+        QByteArray bodySuffix;
+        int ttl = 0;
+    };
 
-private slots:
-    void updateCloudflareDns(bool isIpv4);
+    using ReplyHandler = std::function<void(ManagedReply *)>;
+    // 从令牌池选取令牌发出请求，认证失败或限流时更新令牌状态；401/403 时换一个可用令牌重试一次，
+    // done 只收到最后一次尝试的结果。attach 在每次尝试发出后调用，用于连接流式数据；streamed 只用于 GET
+    void send(const QByteArray &verb, const QNetworkRequest &request, const QByteArray &data, ReplyHandler done,
+              ReplyHandler attach = nullptr, bool streamed = false, bool retried = false);
 
-signals:
-    void searchComplete(bool isIpv4);
-    void IpRecordExist(bool isIpv4);
-    void IpRecordNotMatch(bool isIpv4);
+    QNetworkRequest zoneRequest(const QString &path) const;
+    // 区域级别的请求在加载配置时生成
+    void compileZoneRequests();
+    // 取得记录的请求计划，缺少的部分按需生成
+    RecordPlan &plan(int row);
+    void setRecordId(int row, const QString &recordId);
+    void appendRecordBody(QByteArray &body, int index, bool withId);
 
-private:
-    QNetworkAccessManager *networkManager_;
+    void searchCloudflareRecords(const QString &type, int page = 1);
+    void applyChanges();
+    void createNewRecord(int index);
+    void updateExistRecord(int index);
+    void batchUpdate(const QList<int> &patches, const QList<int> &posts);
+    void handleCloudflareReply(ManagedReply *reply, int index);
+    void finishUpdate(bool success, const QString &message);
 
-    QString apiKey_;
+private:
+    TokenPool tokens_;
     QString zoneId_;
     QString domain_;
-    QJsonObject ipv4_data_;
-    QJsonObject ipv6_data_;
+    QString endpoint_;
+
+    // 本轮要写入的记录，名称已补全域名；rows_ 为各记录在 table_ 中的行号
+    QList<DnsRecord> records_;
+    QList<int> rows_;
+    // 记录ID、查询到的现有内容和 TTL，跨轮次保留
+    RecordTable table_;
+    // 与 table_ 的行一一对应
+    QList<RecordPlan> plans_;
+
+    QNetworkRequest createRequest_;
+    QNetworkRequest batchRequest_;
+    QHash<QString, QNetworkRequest> listRequests_;
+    // 与令牌池下标对应的 Authorization 头
+    QList<QByteArray> authHeaders_;
 
-    // 用于存储记录ID的变量
-    QString ipv4RecordId_ = QString();
-    QString ipv6RecordId_ = QString();
+    // 本轮更新中尚未完成的查询数
+    int pending_ = 0;
+    QStringList errors_;
+    int unchanged_ = 0;
 };
 
 #endif // CLOUDFLARE_H
@@ -0,0 +1,63 @@
+#include "cloudflareformat.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QUrl>
+
+QNetworkRequest CloudflareFormat::zoneRequest(const QString &endpoint, const QString &zoneId, const QString &path)
+{
+    QNetworkRequest request(QUrl(QString("%1zones/%2/%3").arg(endpoint, zoneId, path)));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    return request;
+}
+
+QByteArray CloudflareFormat::authHeader(const QString &token)
+{
+    return "Bearer " + token.toUtf8();
+}
+
+QByteArray CloudflareFormat::bodyPrefix(const QString &type, const QString &name)
+{
+    // 名称经过 JSON 转义，content 的值补在前缀之后
+    QByteArray fields = QJsonDocument(QJsonObject{{"name", name}, {"type", type}}).toJson(QJsonDocument::Compact);
+    fields.chop(1);
+    return fields + ",\"content\":\"";
+}
+
+QByteArray CloudflareFormat::patchPrefix(const QString &recordId, const QByteArray &bodyPrefix)
+{
+    return "{\"id\":\"" + recordId.toLatin1() + "\"," + bodyPrefix.mid(1);
+}
+
+QByteArray CloudflareFormat::bodySuffix(int ttl)
+{
+    return "\",\"ttl\":" + QByteArray::number(ttl) + "}";
+}
+
+void CloudflareFormat::appendBody(QByteArray &body, const QByteArray &prefix, const QString &content,
+                                  const QByteArray &suffix)
+{
+    body.append(prefix);
+    // 内容是地址，只含 ASCII 字符
+    for (const QChar c : content) {
+        body.append(char(c.unicode()));
+    }
+    body.append(suffix);
+}
+
+QString CloudflareFormat::firstError(const QJsonObject &reply)
+{
+    return reply["errors"].toArray().first().toObject()["message"].toString();
+}
+
+bool CloudflareFormat::parseRecordReply(const QByteArray &data, QString &recordId, QString &error)
+{
+    const QJsonObject jsonObj = QJsonDocument::fromJson(data).object();
+    if (!jsonObj["success"].toBool()) {
+        error = firstError(jsonObj);
+        return false;
+    }
+    recordId = jsonObj["result"].toObject()["id"].toString();
+    return true;
+}
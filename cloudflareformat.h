@@ -0,0 +1,33 @@
+#ifndef CLOUDFLAREFORMAT_H
+#define CLOUDFLAREFORMAT_H
+
+#include <QString>
+#include <QByteArray>
+#include <QNetworkRequest>
+#include <QJsonObject>
+
+// Cloudflare 请求和响应的格式：请求地址、认证头、记录正文的拼接和单条记录响应的解析
+//
+// 与网络请求和记录缓存无关，Cloudflare 和基准测试共用同一份实现。
+class CloudflareFormat
+{
+public:
+    // 区域下的接口请求，path 相对于 zones/<zone>/
+    static QNetworkRequest zoneRequest(const QString &endpoint, const QString &zoneId, const QString &path);
+    static QByteArray authHeader(const QString &token);
+
+    // 记录正文 {"name":..,"type":..,"content":"<地址>","ttl":..} 拆成地址前后两部分，
+    // 记录名不变时前缀可以复用，TTL 不变时后缀可以复用
+    static QByteArray bodyPrefix(const QString &type, const QString &name);
+    // 批量修改时带上记录ID
+    static QByteArray patchPrefix(const QString &recordId, const QByteArray &bodyPrefix);
+    static QByteArray bodySuffix(int ttl);
+    static void appendBody(QByteArray &body, const QByteArray &prefix, const QString &content, const QByteArray &suffix);
+
+    // 解析创建或修改单条记录的响应；成功时取出记录ID，失败时取出服务端的错误信息
+    static bool parseRecordReply(const QByteArray &data, QString &recordId, QString &error);
+    // 响应中的第一条错误信息
+    static QString firstError(const QJsonObject &reply);
+};
+
+#endif // CLOUDFLAREFORMAT_H
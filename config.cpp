@@ -3,6 +3,7 @@
 #include <QDir>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
 
 int Config::init()
 {
@@ -66,6 +67,72 @@ QString Config::getIpv6RecordName() {
     return config_["ipv6_record"].toString();
 }
 
+QStringList Config::getTargetProviders()
+{
+    QStringList targets;
+    const QJsonArray array = config_[KEY_TARGET_PROVIDERS].toArray();
+    for (const QJsonValue &value : array) {
+        targets.append(value.toString());
+    }
+
+    // 旧配置只有单个服务商
+    if (targets.isEmpty() && !getLastProviderName().isEmpty()) {
+        targets.append(getLastProviderName());
+    }
+    return targets;
+}
+
+int Config::getCycleBudget()
+{
+    // 单位秒
+    return config_[KEY_CYCLE_BUDGET].toInt(60);
+}
+
+QString Config::getPushSocket()
+{
+    // 默认不启用推送接口，需在配置中填写套接字名称
+    return config_[KEY_PUSH_SOCKET].toString();
+}
+
+bool Config::getHostCoordination()
+{
+    // 同机多个实例共享地址发现和写入结果
+    return config_[KEY_HOST_COORDINATION].toBool(true);
+}
+
+QJsonArray Config::getFailoverConfig()
+{
+    // 每项为一个故障切换组：记录名与按优先级排列的候选地址
+    return config_["failover"].toArray();
+}
+
+QJsonArray Config::getUplinkConfig()
+{
+    // 多出口：每项为一条上行链路的接口或源地址及其记录名
+    return config_["uplinks"].toArray();
+}
+
+QJsonObject Config::getDampingConfig()
+{
+    return config_["damping"].toObject();
+}
+
+int Config::getRecordTtl()
+{
+    // 1 表示由服务商自动决定
+    return config_["ttl"].toInt(1);
+}
+
+QJsonObject Config::getDynamicTtlConfig()
+{
+    return config_["dynamic_ttl"].toObject();
+}
+
+QJsonObject Config::getPrefixDelegationConfig()
+{
+    return config_["ipv6_prefix"].toObject();
+}
+
 bool Config::getProvider(QJsonObject &provider, QString &provider_name)
 {
     if(!config_.contains("providers")) {
@@ -85,6 +152,7 @@ bool Config::saveConfig(const QJsonObject &config) {
     }
 
     file.write(doc.toJson());
+    config_ = config;
     qInfo() << "Configuration saved successfully.";
     return true;
 }
@@ -4,8 +4,14 @@
 #include <QString>
 #include <QComboBox>
 #include <QJsonObject>
+#include <QJsonArray>
+#include <QStringList>
 
 static const QString KEY_LAST_PROVIDER = "last_provider";
+static const QString KEY_TARGET_PROVIDERS = "target_providers";
+static const QString KEY_CYCLE_BUDGET = "cycle_budget";
+static const QString KEY_PUSH_SOCKET = "push_socket";
+static const QString KEY_HOST_COORDINATION = "host_coordination";
 
 class Config
 {
@@ -18,11 +24,24 @@ public:
     int init();
 
     bool saveConfig(const QJsonObject &config);
+    QJsonObject getConfig() const { return config_; }
+    // 只替换内存中的配置，不写入文件（模拟模式）
+    void setConfig(const QJsonObject &config) { config_ = config; }
     bool getProvider(QJsonObject &provider, QString &provider_name);
 
     QString getLastProviderName();
     QString getIpv4RecordName();
     QString getIpv6RecordName();
+    QStringList getTargetProviders();
+    int getCycleBudget();
+    QJsonObject getDampingConfig();
+    int getRecordTtl();
+    QJsonObject getDynamicTtlConfig();
+    QJsonObject getPrefixDelegationConfig();
+    QString getPushSocket();
+    bool getHostCoordination();
+    QJsonArray getFailoverConfig();
+    QJsonArray getUplinkConfig();
 private:
     Config() = default;
     ~Config() = default;
@@ -0,0 +1,563 @@
+#include "ddnsservice.h"
+#include "config.h"
+
+#include <QDebug>
+
+// 共享地址的有效期，超过后说明主实例已停止发现，自行探测
+static const qint64 SHARED_ADDRESS_MAX_AGE = 10 * 60 * 1000;
+
+DdnsService::DdnsService(QNetworkAccessManager *networkManager, QObject *parent)
+    : QObject(parent)
+    , requestManager_(new RequestManager(networkManager, this))
+    , dispatcher_(new UpdateDispatcher(this))
+    , damper_(new FlapDamper(this))
+    , reachability_(new Reachability(this))
+    , discovery_(new IpDiscovery(requestManager_, this))
+    , pushServer_(new PushServer(this))
+    , coordinator_(new HostCoordinator(this))
+    , failover_(new Failover(requestManager_, this))
+    , uplinks_(new UplinkDiscovery(this))
+    , discoveryTimer_(new WheelTimer(this))
+    , verifyTimer_(new WheelTimer(this))
+{
+    connectDiscovery();
+
+    connect(pushServer_, &PushServer::addressPushed, this, &DdnsService::onAddressPushed);
+    connect(pushServer_, &PushServer::updateRequested, this, &DdnsService::onUpdateRequested);
+
+    connect(damper_, &FlapDamper::addressStable, this, &DdnsService::onAddressStable);
+    connect(damper_, &FlapDamper::stateChanged, this, &DdnsService::onDampingStateChanged);
+
+    connect(failover_, &Failover::targetChanged, this, &DdnsService::onFailoverChanged);
+
+    connect(uplinks_, &UplinkDiscovery::addressChanged, this, &DdnsService::onUplinkChanged);
+    connect(uplinks_, &UplinkDiscovery::failed, this, [](const QString &uplink, bool isIpv4, const QString &reason) {
+        qWarning() << QString("uplink %1 %2: %3").arg(uplink, QString(isIpv4 ? "IPv4" : "IPv6"), reason);
+    });
+
+    connect(dispatcher_, &UpdateDispatcher::cycleFinished, this, &DdnsService::onCycleFinished);
+
+    connect(reachability_, &Reachability::online, this, &DdnsService::onNetworkOnline);
+    connect(reachability_, &Reachability::offline, this, &DdnsService::onNetworkOffline);
+
+    // 周期任务允许少量推迟，与其他定时任务合并唤醒
+    discoveryTimer_->setSlack(10000);
+    verifyTimer_->setSlack(10000);
+    connect(discoveryTimer_, &WheelTimer::timeout, this, [this]() { refreshAddresses(); });
+    connect(verifyTimer_, &WheelTimer::timeout, this, &DdnsService::updateDNS);
+
+    // 上次未能写入的状态；日志要扫描文件，由 openJournal() 在启动完成后打开
+    pendingQueue_.load();
+    stateCache_.load();
+}
+
+bool DdnsService::openJournal()
+{
+    journal_.open();
+
+    // 状态文件丢失或损坏时从日志重建
+    if (!stateCache_.isEmpty()) {
+        return false;
+    }
+    JournalReader reader(journal_.directory());
+    if (!reader.open() || !reader.rebuild(stateCache_)) {
+        return false;
+    }
+    qInfo() << "state cache rebuilt from journal";
+    stateCache_.save();
+    return true;
+}
+
+void DdnsService::connectDiscovery()
+{
+    connect(discovery_, &IpDiscovery::discovered, this, &DdnsService::onAddressObserved);
+    connect(discovery_, &IpDiscovery::failed, this, &DdnsService::discoveryFailed);
+    connect(discovery_, &IpDiscovery::finished, this, &DdnsService::discoveryFinished);
+}
+
+void DdnsService::setDiscovery(IpDiscovery *discovery)
+{
+    discovery_->disconnect(this);
+    discovery_->deleteLater();
+
+    discovery_ = discovery;
+    discovery_->setParent(this);
+    connectDiscovery();
+}
+
+void DdnsService::reloadConfig()
+{
+    Config &config = Config::getInstance();
+    // 用户保存设置后，下一轮重新加载所有服务商的配置
+    loadedConfigs_.clear();
+    targets_ = config.getTargetProviders();
+    ipv4RecordName_ = config.getIpv4RecordName();
+    ipv6RecordName_ = config.getIpv6RecordName();
+
+    dispatcher_->setCycleBudget(config.getCycleBudget() * 1000);
+    damper_->loadConfig(config.getDampingConfig());
+    ttlPolicy_.loadConfig(config.getRecordTtl(), config.getDynamicTtlConfig());
+    prefixDelegation_.loadConfig(config.getPrefixDelegationConfig());
+    coordinator_->setEnabled(coordinated_ && config.getHostCoordination());
+    failover_->loadConfig(config.getFailoverConfig());
+    uplinks_->loadConfig(config.getUplinkConfig());
+}
+
+void DdnsService::start()
+{
+    running_ = true;
+    pushServer_->setUpdateEnabled(true);
+    // 故障切换记录在首轮探测完成后加入更新
+    failover_->start();
+    updateDNS(); // 立即执行一次更新
+    verifyTimer_->start(ttlPolicy_.verifyInterval()); // 每个 TTL 校验一次
+}
+
+void DdnsService::stop()
+{
+    running_ = false;
+    pushServer_->setUpdateEnabled(false);
+    verifyTimer_->stop();
+    failover_->stop();
+    dispatcher_->cancel();
+    // 不再写入的实例不能继续占着写入锁，否则其他实例会一直跳过；
+    // 地址发现与是否开启 DDNS 无关，发现锁继续保留
+    coordinator_->releaseUpdates();
+}
+
+void DdnsService::startPolling(int interval)
+{
+    // 加载后端插件较慢，只有常驻运行需要监测连通性
+    reachability_->start();
+    refreshAddresses();
+    discoveryTimer_->start(interval);
+}
+
+bool DdnsService::startPushServer()
+{
+    const QString name = Config::getInstance().getPushSocket();
+    if (name.isEmpty()) {
+        pushServer_->close();
+        return false;
+    }
+    return pushServer_->listen(name);
+}
+
+void DdnsService::setFamilyEnabled(bool isIpv4, bool enabled)
+{
+    if (isIpv4) {
+        ipv4Enabled_ = enabled;
+    } else {
+        ipv6Enabled_ = enabled;
+    }
+}
+
+void DdnsService::refreshAddresses(int timeout)
+{
+    // 各出口各自绑定源地址查询，与默认出口的发现并行
+    if (!uplinks_->isEmpty()) {
+        uplinks_->discover(timeout);
+    }
+
+    // 同机已有实例负责发现地址时直接使用其结果
+    if (coordinator_->isEnabled() && !coordinator_->acquireDiscovery()) {
+        readSharedAddresses();
+        return;
+    }
+    discovery_->discover(timeout);
+}
+
+void DdnsService::readSharedAddresses()
+{
+    bool found = false;
+    for (bool isIpv4 : {true, false}) {
+        QString address;
+        if (coordinator_->sharedAddress(isIpv4, SHARED_ADDRESS_MAX_AGE, address)) {
+            found = true;
+            onAddressObserved(isIpv4, address);
+        } else {
+            emit discoveryFailed(isIpv4, "No address shared by the leading instance");
+        }
+    }
+
+    if (!found) {
+        // 主实例没有在更新共享结果，自行发现
+        qInfo() << "shared addresses are stale, discovering locally";
+        discovery_->discover(30000);
+        return;
+    }
+    emit discoveryFinished();
+}
+
+void DdnsService::onAddressObserved(bool isIpv4, const QString &address)
+{
+    emit addressDiscovered(isIpv4, address);
+    journal_.recordDiscovery(isIpv4, address);
+    // 只有负责发现的实例会写入共享内存
+    coordinator_->publishAddress(isIpv4, address);
+
+    if (dampingEnabled_) {
+        damper_->observe(isIpv4, address);
+    } else {
+        onAddressStable(isIpv4, address);
+    }
+}
+
+void DdnsService::onAddressStable(bool isIpv4, const QString &address)
+{
+    QString &current = isIpv4 ? currentIPv4_ : currentIPv6_;
+    if (address == current) {
+        return;
+    }
+
+    qInfo() << QString("%1 changed: %2 -> %3").arg(isIpv4 ? "IPv4" : "IPv6").arg(current).arg(address);
+    if (!isIpv4 && prefixDelegation_.isEnabled()
+        && prefixDelegation_.prefix(current) != prefixDelegation_.prefix(address)) {
+        qInfo() << QString("delegated prefix changed to %1, %2 record(s) derived")
+                       .arg(prefixDelegation_.prefix(address))
+                       .arg(prefixDelegation_.derive(address).size());
+    }
+    // 首次发现不算作地址变化
+    if (!current.isEmpty()) {
+        ttlPolicy_.noteInstability();
+    }
+    journal_.recordChange(isIpv4, current, address);
+    current = address;
+
+    stateCache_.setAddress(isIpv4, address);
+    stateCache_.save();
+    emit addressCommitted(isIpv4, address);
+
+    // 新地址会取代仍在进行的旧一轮更新，避免旧地址在新地址之后写入
+    if (running_) {
+        updateDNS();
+    }
+}
+
+void DdnsService::onAddressPushed(bool isIpv4, const QString &address)
+{
+    emit addressDiscovered(isIpv4, address);
+    journal_.recordDiscovery(isIpv4, address);
+
+    // 推送来源本身就知道地址何时变化，不再经过稳定窗口；
+    // 主实例未必收到同样的推送，这一轮由本实例自己写入
+    // 之后轮询发现相同地址时不再当作新的候选，也不会把之前的候选地址提交回去
+    damper_->commit(isIpv4, address);
+    bypassCoordination_ = true;
+    onAddressStable(isIpv4, address);
+    bypassCoordination_ = false;
+}
+
+void DdnsService::onFailoverChanged(const QString &record, const QString &address)
+{
+    Q_UNUSED(record);
+    Q_UNUSED(address);
+    emit stateChanged();
+
+    // 切换后立即写入，与其他记录一起经过现有的更新流程
+    if (running_) {
+        updateDNS();
+    }
+}
+
+void DdnsService::onUplinkChanged(const QString &uplink, bool isIpv4, const QString &address)
+{
+    Q_UNUSED(isIpv4);
+    Q_UNUSED(address);
+    emit stateChanged();
+
+    if (!running_ || targets_.isEmpty()) {
+        return;
+    }
+    // 进行中的一轮会被取代，离线时也要合并进待发送队列，这两种情况整轮重写
+    if (dispatcher_->isRunning() || !reachability_->isOnline()) {
+        updateDNS();
+        return;
+    }
+
+    // 出口地址由该链路自己探测，变化后只需重写它对应的记录
+    QList<DnsRecord> records = filtered(uplinks_->records(uplink));
+    if (records.isEmpty()) {
+        return;
+    }
+    for (DnsRecord &record : records) {
+        record.extra = true;
+    }
+    PendingQueue::DesiredState state;
+    state.ipv4 = ipv4Enabled_ ? currentIPv4_ : QString();
+    state.ipv6 = ipv6Enabled_ ? currentIPv6_ : QString();
+    state.ipv4RecordName = ipv4RecordName_;
+    state.ipv6RecordName = ipv6RecordName_;
+    startUpdate(targets_, state, records);
+}
+
+void DdnsService::onUpdateRequested()
+{
+    if (!running_) {
+        qInfo() << "update requested but DDNS is not running";
+        return;
+    }
+    updateDNS();
+}
+
+void DdnsService::onDampingStateChanged()
+{
+    // 有待确认的新地址说明链路不稳定
+    if (!damper_->state(true).candidate.isEmpty() || !damper_->state(false).candidate.isEmpty()) {
+        ttlPolicy_.noteInstability();
+    }
+    emit stateChanged();
+}
+
+void DdnsService::updateDNS()
+{
+    // 使用经过稳定窗口确认的地址，而不是最新探测到的值
+    PendingQueue::DesiredState state;
+    state.ipv4 = ipv4Enabled_ ? currentIPv4_ : QString();
+    state.ipv6 = ipv6Enabled_ ? currentIPv6_ : QString();
+    state.ipv4RecordName = ipv4RecordName_;
+    state.ipv6RecordName = ipv6RecordName_;
+
+    if (!recordFilter_.isEmpty()) {
+        const bool derived = prefixDelegation_.recordNames().contains(recordFilter_);
+        const bool extra = failover_->recordNames().contains(recordFilter_)
+                           || uplinks_->recordNames().contains(recordFilter_);
+        if (ipv4RecordName_ != recordFilter_ && ipv6RecordName_ != recordFilter_ && !derived && !extra) {
+            emit configError(QString("No record named %1").arg(recordFilter_));
+            return;
+        }
+        if (ipv4RecordName_ != recordFilter_) {
+            state.ipv4.clear();
+        }
+        if (ipv6RecordName_ != recordFilter_ && !derived) {
+            state.ipv6.clear();
+        }
+    }
+
+    if (targets_.isEmpty()) {
+        emit configError("Please select at least one provider to update.");
+        return;
+    }
+
+    if (state.ipv4.isEmpty() && state.ipv6.isEmpty() && extraRecords().isEmpty()) {
+        emit updateSkipped("No public IP address selected for DDNS update. Please check your network connection and IP selection.");
+        return;
+    }
+
+    // 离线时放入待发送队列，联网后立即补发
+    if (!reachability_->isOnline()) {
+        pendingQueue_.enqueue(targets_, state);
+        emit updateQueued(pendingQueue_.providers().size(), offlineSince_);
+        return;
+    }
+
+    startUpdate(targets_, state);
+}
+
+DnsProvider *DdnsService::getProvider(const QString &provider)
+{
+    if (!providers_.contains(provider)) {
+        providers_.insert(provider, DnsProvider::create(provider, requestManager_, this));
+    }
+    return providers_.value(provider);
+}
+
+QString DdnsService::recordsKey(const PendingQueue::DesiredState &state)
+{
+    return state.ipv4RecordName + "," + state.ipv6RecordName;
+}
+
+QList<DnsRecord> DdnsService::recordsFor(const PendingQueue::DesiredState &state) const
+{
+    QList<DnsRecord> records;
+    if (!state.ipv4.isEmpty()) {
+        records.append({"A", state.ipv4RecordName, state.ipv4});
+    }
+    if (!state.ipv6.isEmpty()) {
+        // 只配置了前缀委派记录时不写主 AAAA 记录
+        if (!state.ipv6RecordName.isEmpty() || !prefixDelegation_.isEnabled()) {
+            records.append({"AAAA", state.ipv6RecordName, state.ipv6});
+        }
+        records.append(prefixDelegation_.derive(state.ipv6));
+    }
+    // 故障切换组的当前活动目标和各出口自己的记录
+    for (DnsRecord record : failover_->records() + uplinks_->records()) {
+        record.extra = true;
+        records.append(record);
+    }
+    return filtered(records);
+}
+
+QStringList DdnsService::extraRecords() const
+{
+    QStringList records;
+    const QList<DnsRecord> extra = filtered(failover_->records() + uplinks_->records());
+    for (const DnsRecord &record : extra) {
+        records.append(QString("%1 %2 %3").arg(record.type, record.name, record.content));
+    }
+    records.sort();
+    return records;
+}
+
+QList<DnsRecord> DdnsService::filtered(const QList<DnsRecord> &records) const
+{
+    if (recordFilter_.isEmpty()) {
+        return records;
+    }
+    QList<DnsRecord> filtered;
+    for (const DnsRecord &record : std::as_const(records)) {
+        if (record.name == recordFilter_) {
+            filtered.append(record);
+        }
+    }
+    return filtered;
+}
+
+void DdnsService::startUpdate(const QStringList &providers, const PendingQueue::DesiredState &state,
+                              const QList<DnsRecord> &records)
+{
+    const bool partial = !records.isEmpty();
+    const QStringList extra = extraRecords();
+    const QJsonObject providerConfigs = Config::getInstance().getConfig()["providers"].toObject();
+    const int ttl = ttlPolicy_.recordTtl();
+
+    // 执行DDNS更新，所有目标服务商并行进行
+    QList<DnsProvider *> active;
+    QStringList deferred;
+    for (const QString &name : providers) {
+        DnsProvider *provider = getProvider(name);
+        if (!provider) {
+            qWarning() << QString("%1 is not supported yet, skipped").arg(name);
+            continue;
+        }
+        // 无法按记录名写入的服务商会把其他子域名一并覆盖，留到下次整轮校验时写入
+        if (partial && !provider->addressesRecordsByName()) {
+            continue;
+        }
+
+        if (!partial && skipPublished_ && stateCache_.isPublished(name, state.ipv4, state.ipv6, extra, ttl)) {
+            qInfo() << QString("%1 already up to date, skipped").arg(name);
+            pendingQueue_.remove(name);
+            continue;
+        }
+
+        // 同机另一个实例负责这组记录时，只同步它的结果
+        if (coordinator_->isEnabled() && !bypassCoordination_
+            && !coordinator_->acquireUpdate(name, recordsKey(state))) {
+            StateCache::Published shared;
+            const bool found = coordinator_->sharedResult(name, recordsKey(state), shared);
+            if (found) {
+                stateCache_.setPublished(name, shared);
+                stateCache_.save();
+            }
+            // 只有对方已成功写入相同的地址才算最新，否则留在队列中等下次校验
+            if (found && shared.success && shared.ipv4 == state.ipv4 && shared.ipv6 == state.ipv6
+                && shared.records == extra) {
+                qInfo() << QString("%1 is updated by another instance, skipped").arg(name);
+                pendingQueue_.remove(name);
+            } else {
+                qInfo() << QString("%1 is being updated by another instance").arg(name);
+                deferred.append(name);
+            }
+            continue;
+        }
+
+        const QJsonObject providerConfig = providerConfigs[name].toObject();
+        if (!loadedConfigs_.contains(name) || loadedConfigs_.value(name) != providerConfig) {
+            QString error;
+            if (!provider->loadConfig(providerConfig, error)) {
+                loadedConfigs_.remove(name);
+                emit configError(QString("%1: %2").arg(name, error));
+                continue;
+            }
+            loadedConfigs_.insert(name, providerConfig);
+        }
+        provider->setRecordTtl(ttl);
+        active.append(provider);
+    }
+
+    if (active.isEmpty()) {
+        if (deferred.isEmpty()) {
+            emit upToDate();
+        } else {
+            emit updateDeferred(deferred);
+        }
+        return;
+    }
+
+    cycleState_ = state;
+    cyclePartial_ = partial;
+    cycleRecords_ = extra;
+    // 一次前缀变化产生的全部记录在同一轮中批量写入
+    dispatcher_->start(active, partial ? records : recordsFor(state));
+}
+
+void DdnsService::onCycleFinished(bool success, const QList<ProviderStatus> &statuses)
+{
+    Q_UNUSED(success);
+
+    // 下次校验按当前 TTL 重新排期
+    if (running_) {
+        verifyTimer_->start(ttlPolicy_.verifyInterval());
+    }
+
+    // 失败的服务商进入待发送队列，成功的移出
+    QStringList failed;
+    for (const ProviderStatus &s : statuses) {
+        // 只写了部分记录，主记录的发布状态不变；失败时整轮补发
+        if (cyclePartial_) {
+            if (!s.success) {
+                failed.append(s.provider);
+                continue;
+            }
+            StateCache::Published published = stateCache_.published(s.provider);
+            if (published.success) {
+                published.records = cycleRecords_;
+                stateCache_.setPublished(s.provider, published);
+            }
+            continue;
+        }
+
+        StateCache::Published published;
+        published.ipv4 = cycleState_.ipv4;
+        published.ipv6 = cycleState_.ipv6;
+        published.records = cycleRecords_;
+        published.ttl = ttlPolicy_.recordTtl();
+        published.success = s.success;
+        published.message = s.message;
+        published.time = QDateTime::currentDateTime();
+        stateCache_.setPublished(s.provider, published);
+        coordinator_->publishResult(s.provider, recordsKey(cycleState_), published);
+        journal_.recordWrite(s.provider, published, s.elapsedMs);
+
+        if (s.success) {
+            pendingQueue_.remove(s.provider);
+        } else {
+            failed.append(s.provider);
+        }
+    }
+    if (!failed.isEmpty()) {
+        pendingQueue_.enqueue(failed, cycleState_);
+    }
+    stateCache_.save();
+    emit stateChanged();
+}
+
+void DdnsService::onNetworkOnline()
+{
+    qInfo() << "network back online";
+    if (running_ && !pendingQueue_.isEmpty()) {
+        // 离线期间的多次变化已合并为最新的期望状态，一次性补发
+        qInfo() << QString("replay queued update for %1 provider(s)").arg(pendingQueue_.providers().size());
+        startUpdate(pendingQueue_.providers(), pendingQueue_.desired());
+    }
+
+    // 重新联网后地址很可能已经变化
+    refreshAddresses();
+}
+
+void DdnsService::onNetworkOffline()
+{
+    offlineSince_ = QDateTime::currentDateTime();
+    emit updateQueued(pendingQueue_.providers().size(), offlineSince_);
+}
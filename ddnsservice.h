@@ -0,0 +1,183 @@
+#ifndef DDNSSERVICE_H
+#define DDNSSERVICE_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QNetworkAccessManager>
+
+#include "dnsprovider.h"
+#include "updatedispatcher.h"
+#include "flapdamper.h"
+#include "ttlpolicy.h"
+#include "prefixdelegation.h"
+#include "pendingqueue.h"
+#include "reachability.h"
+#include "ipdiscovery.h"
+#include "requestmanager.h"
+#include "statecache.h"
+#include "pushserver.h"
+#include "timerwheel.h"
+#include "hostcoordinator.h"
+#include "failover.h"
+#include "journal.h"
+#include "uplinkdiscovery.h"
+
+// 不依赖界面的更新流程：地址发现 -> 抖动抑制 -> 并行写入各服务商
+class DdnsService : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DdnsService(QNetworkAccessManager *networkManager, QObject *parent = nullptr);
+
+    // 从 Config 读取记录名、目标服务商及各项参数
+    void reloadConfig();
+    // 打开事件日志，状态缓存为空时从日志重建；返回是否重建了状态缓存
+    bool openJournal();
+
+    void start();
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // 定期发现地址（与是否开启 DDNS 无关）
+    void startPolling(int interval);
+    // 按配置监听本地推送接口
+    bool startPushServer();
+
+    // 替换地址来源（模拟模式）
+    void setDiscovery(IpDiscovery *discovery);
+
+    void setFamilyEnabled(bool isIpv4, bool enabled);
+    bool isFamilyEnabled(bool isIpv4) const { return isIpv4 ? ipv4Enabled_ : ipv6Enabled_; }
+    // 只更新指定名称的记录
+    void setRecordFilter(const QString &record) { recordFilter_ = record; }
+    // 关闭后发现的地址直接提交，不经过稳定窗口（单次运行）
+    void setDampingEnabled(bool enabled) { dampingEnabled_ = enabled; }
+    // 跳过已成功写入相同内容的服务商
+    void setSkipPublished(bool skip) { skipPublished_ = skip; }
+    // 关闭后不参与同机实例间的协调，自己发现并写入（单次运行）
+    void setCoordinated(bool coordinated) { coordinated_ = coordinated; }
+
+    QString address(bool isIpv4) const { return isIpv4 ? currentIPv4_ : currentIPv6_; }
+    QStringList targetProviders() const { return targets_; }
+    QString recordName(bool isIpv4) const { return isIpv4 ? ipv4RecordName_ : ipv6RecordName_; }
+
+    UpdateDispatcher *dispatcher() const { return dispatcher_; }
+    // 已创建的服务商实例，尚未参与过更新时返回 nullptr
+    DnsProvider *provider(const QString &name) const { return providers_.value(name); }
+    FlapDamper *damper() const { return damper_; }
+    Reachability *reachability() const { return reachability_; }
+    IpDiscovery *discovery() const { return discovery_; }
+    RequestManager *requestManager() const { return requestManager_; }
+    PushServer *pushServer() const { return pushServer_; }
+    HostCoordinator *coordinator() const { return coordinator_; }
+    Failover *failover() const { return failover_; }
+    UplinkDiscovery *uplinks() const { return uplinks_; }
+    const TtlPolicy &ttlPolicy() const { return ttlPolicy_; }
+    const PrefixDelegation &prefixDelegation() const { return prefixDelegation_; }
+    const PendingQueue &pendingQueue() const { return pendingQueue_; }
+    const StateCache &stateCache() const { return stateCache_; }
+    const Journal &journal() const { return journal_; }
+
+public slots:
+    void refreshAddresses(int timeout = 30000);
+    void updateDNS();
+
+signals:
+    void addressDiscovered(bool isIpv4, const QString &address);
+    void discoveryFailed(bool isIpv4, const QString &reason);
+    void discoveryFinished();
+    void addressCommitted(bool isIpv4, const QString &address);
+    void stateChanged();
+
+    // 没有可写入的地址
+    void updateSkipped(const QString &reason);
+    // 所有服务商已是最新，未发出请求
+    void upToDate();
+    // 写入由同机另一个实例负责，尚未看到它对当前地址的成功结果
+    void updateDeferred(const QStringList &providers);
+    void configError(const QString &message);
+    void updateQueued(int providers, const QDateTime &offlineSince);
+
+private:
+    void connectDiscovery();
+    // 由其他实例负责发现时，读取其共享的地址
+    void readSharedAddresses();
+    // 协调锁的记录部分：同一组记录名由同一个实例写入
+    static QString recordsKey(const PendingQueue::DesiredState &state);
+    DnsProvider *getProvider(const QString &provider);
+
+    // 期望状态对应的全部记录：主记录加上前缀委派推导的 AAAA 记录
+    QList<DnsRecord> recordsFor(const PendingQueue::DesiredState &state) const;
+    // 故障切换和各出口的当前记录，用于比较是否已写入
+    QStringList extraRecords() const;
+    // 按记录名过滤（单次运行）
+    QList<DnsRecord> filtered(const QList<DnsRecord> &records) const;
+    // records 不为空时只写入这些记录（单个出口的变化），不改变主记录的发布状态
+    void startUpdate(const QStringList &providers, const PendingQueue::DesiredState &state,
+                     const QList<DnsRecord> &records = QList<DnsRecord>());
+    void onAddressObserved(bool isIpv4, const QString &address);
+    void onAddressStable(bool isIpv4, const QString &address);
+    void onAddressPushed(bool isIpv4, const QString &address);
+    void onUpdateRequested();
+    void onDampingStateChanged();
+    void onFailoverChanged(const QString &record, const QString &address);
+    void onUplinkChanged(const QString &uplink, bool isIpv4, const QString &address);
+    void onCycleFinished(bool success, const QList<ProviderStatus> &statuses);
+    void onNetworkOnline();
+    void onNetworkOffline();
+
+private:
+    RequestManager *requestManager_;
+    UpdateDispatcher *dispatcher_;
+    FlapDamper *damper_;
+    Reachability *reachability_;
+    IpDiscovery *discovery_;
+    PushServer *pushServer_;
+    HostCoordinator *coordinator_;
+    Failover *failover_;
+    UplinkDiscovery *uplinks_;
+    TtlPolicy ttlPolicy_;
+    PrefixDelegation prefixDelegation_;
+    PendingQueue pendingQueue_;
+    StateCache stateCache_;
+    Journal journal_;
+
+    // 已创建的服务商实例，跨更新周期复用以保留记录ID缓存
+    QMap<QString, DnsProvider *> providers_;
+    // 各服务商上次成功加载的配置，未变化时不重新解析令牌和认证头
+    QHash<QString, QJsonObject> loadedConfigs_;
+
+    WheelTimer *discoveryTimer_;
+    WheelTimer *verifyTimer_;
+
+    QStringList targets_;
+    QString ipv4RecordName_;
+    QString ipv6RecordName_;
+    QString recordFilter_;
+    bool ipv4Enabled_ = true;
+    bool ipv6Enabled_ = true;
+    bool dampingEnabled_ = true;
+    bool skipPublished_ = false;
+    bool coordinated_ = true;
+    // 推送的地址由本实例直接写入，不交给写入主实例
+    bool bypassCoordination_ = false;
+    bool running_ = false;
+
+    // 已确认（经过稳定窗口）的地址
+    QString currentIPv4_;
+    QString currentIPv6_;
+
+    // 正在进行的一轮更新对应的期望状态
+    PendingQueue::DesiredState cycleState_;
+    // 正在进行的一轮只写入部分记录
+    bool cyclePartial_ = false;
+    QStringList cycleRecords_;
+    QDateTime offlineSince_;
+};
+
+#endif // DDNSSERVICE_H
@@ -0,0 +1,251 @@
+#include "dnspod.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+static const QString DEFAULT_ENDPOINT = "https://dnsapi.cn/";
+// DNSPod 对单个账号有频率限制，同时进行的记录操作不宜过多
+static const int MAX_CONCURRENT = 4;
+// 默认线路
+static const QString DEFAULT_LINE_ID = "0";
+// 未指定 TTL 时 DNSPod 使用的值
+static const int DEFAULT_TTL = 600;
+
+// DNSPod 的返回码：1 成功，10 记录列表为空，8 记录ID错误
+static const QString CODE_OK = "1";
+static const QString CODE_NO_RECORDS = "10";
+static const QString CODE_BAD_RECORD_ID = "8";
+
+static QString statusCode(const QJsonObject &jsonObj)
+{
+    return jsonObj["status"].toObject()["code"].toString();
+}
+
+static QString dnspodError(const QJsonObject &jsonObj)
+{
+    const QJsonObject status = jsonObj["status"].toObject();
+    return QString("%1 (%2)").arg(status["message"].toString(), status["code"].toString());
+}
+
+DnsPod::DnsPod(RequestManager *requestManager)
+    : DnsProvider(requestManager)
+{
+    setMaxConcurrent(MAX_CONCURRENT);
+}
+
+bool DnsPod::loadConfig(const QJsonObject &config, QString &error)
+{
+    // 令牌格式为 "ID,Token"
+    QString token = config["token"].toString().trimmed();
+    QString domain = config["domain"].toString().trimmed();
+
+    if (token.isEmpty() || domain.isEmpty()) {
+        error = "Please fill in all DNSPod settings";
+        return false;
+    }
+    if (!token.contains(',')) {
+        error = "DNSPod token must be in the form ID,Token";
+        return false;
+    }
+
+    // 账号或域名变化后，缓存的记录ID失效
+    if (token != token_ || domain != domain_) {
+        recordIds_.clear();
+    }
+
+    endpoint_ = config["endpoint"].toString(DEFAULT_ENDPOINT);
+    token_ = token;
+    domain_ = domain;
+    return true;
+}
+
+ManagedReply *DnsPod::call(const QString &action, const QUrlQuery &params)
+{
+    QUrlQuery form = params;
+    form.addQueryItem("login_token", token_);
+    form.addQueryItem("format", "json");
+    form.addQueryItem("domain", domain_);
+
+    QNetworkRequest request(QUrl(endpoint_ + action));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    // DNSPod 要求带上可识别的 User-Agent，否则可能被封禁
+    request.setHeader(QNetworkRequest::UserAgentHeader, "ddns-qt/0.1");
+
+    return trackReply(requestManager_->post(request, form.toString(QUrl::FullyEncoded).toUtf8()));
+}
+
+void DnsPod::updateDnsRecords(const QList<DnsRecord> &records)
+{
+    for (const DnsRecord &record : records) {
+        if (record.name.isEmpty()) {
+            emit updateFinished(false, QString("Please specify %1 record name").arg(record.type == "A" ? "IPv4" : "IPv6"));
+            return;
+        }
+    }
+
+    pending_ = records.size();
+    success_ = true;
+    messages_.clear();
+
+    if (pending_ == 0) {
+        emit updateFinished(true, "nothing to update");
+        return;
+    }
+
+    for (const DnsRecord &record : records) {
+        runLimited([this, record]() {
+            if (recordIds_.contains(recordKey(record))) {
+                writeRecord(recordIds_.value(recordKey(record)), record, true);
+            } else {
+                listRecord(record);
+            }
+        });
+    }
+}
+
+void DnsPod::finishRecord(const DnsRecord &record, bool success, const QString &message)
+{
+    messages_.append(QString("%1 %2: %3").arg(record.type, record.name, message));
+    success_ = success_ && success;
+    releaseSlot();
+
+    if (--pending_ > 0) {
+        return;
+    }
+    emit updateFinished(success_, messages_.join("; "));
+}
+
+void DnsPod::listRecord(const DnsRecord &record)
+{
+    QUrlQuery params;
+    params.addQueryItem("sub_domain", record.name);
+    params.addQueryItem("record_type", record.type);
+
+    ManagedReply *reply = call("Record.List", params);
+    connect(reply, &ManagedReply::finished, this, [this, reply, record]() {
+        if (isStale(reply)) {
+            return;
+        }
+        if (reply->error() != QNetworkReply::NoError) {
+            finishRecord(record, false, QString("Search record error: %1").arg(reply->errorString()));
+            return;
+        }
+
+        QJsonObject jsonObj = QJsonDocument::fromJson(reply->readAll()).object();
+        const QString code = statusCode(jsonObj);
+        if (code == CODE_NO_RECORDS) {
+            createRecord(record);
+            return;
+        }
+        if (code != CODE_OK) {
+            finishRecord(record, false, QString("Search record error: %1").arg(dnspodError(jsonObj)));
+            return;
+        }
+
+        const QJsonArray result = jsonObj["records"].toArray();
+        if (result.isEmpty()) {
+            createRecord(record);
+            return;
+        }
+        if (result.size() != 1) {
+            finishRecord(record, false, "Record ID count is not equal to 1");
+            return;
+        }
+
+        // DNSPod 的数字字段以字符串返回
+        const QJsonObject recordInfo = result.first().toObject();
+        CachedRecord cached;
+        cached.id = recordInfo["id"].toString();
+        cached.ttl = recordInfo["ttl"].toString().toInt();
+        recordIds_.insert(recordKey(record), cached);
+
+        const int ttl = ttl_ == 1 ? cached.ttl : ttl_;
+        if (recordInfo["value"].toString() == record.content && cached.ttl == ttl) {
+            finishRecord(record, true, "unchanged");
+            return;
+        }
+        writeRecord(cached, record, false);
+    });
+}
+
+void DnsPod::createRecord(const DnsRecord &record)
+{
+    const int ttl = ttl_ == 1 ? DEFAULT_TTL : ttl_;
+
+    QUrlQuery params;
+    params.addQueryItem("sub_domain", record.name);
+    params.addQueryItem("record_type", record.type);
+    params.addQueryItem("record_line_id", DEFAULT_LINE_ID);
+    params.addQueryItem("value", record.content);
+    params.addQueryItem("ttl", QString::number(ttl));
+
+    ManagedReply *reply = call("Record.Create", params);
+    connect(reply, &ManagedReply::finished, this, [this, reply, record, ttl]() {
+        if (isStale(reply)) {
+            return;
+        }
+        if (reply->error() != QNetworkReply::NoError) {
+            finishRecord(record, false, QString("Create record error: %1").arg(reply->errorString()));
+            return;
+        }
+
+        QJsonObject jsonObj = QJsonDocument::fromJson(reply->readAll()).object();
+        if (statusCode(jsonObj) != CODE_OK) {
+            finishRecord(record, false, QString("Create record error: %1").arg(dnspodError(jsonObj)));
+            return;
+        }
+
+        CachedRecord cached;
+        cached.id = jsonObj["record"].toObject()["id"].toString();
+        cached.ttl = ttl;
+        recordIds_.insert(recordKey(record), cached);
+        finishRecord(record, true, "created");
+    });
+}
+
+void DnsPod::writeRecord(const CachedRecord &cached, const DnsRecord &record, bool fromCache)
+{
+    const int ttl = ttl_ == 1 ? cached.ttl : ttl_;
+
+    QUrlQuery params;
+    params.addQueryItem("record_id", cached.id);
+    params.addQueryItem("sub_domain", record.name);
+    params.addQueryItem("record_line_id", DEFAULT_LINE_ID);
+    params.addQueryItem("value", record.content);
+
+    // Record.Ddns 只能改 A 记录的值；AAAA 或 TTL 变化时用 Record.Modify
+    const bool ddns = record.type == "A" && ttl == cached.ttl;
+    if (!ddns) {
+        params.addQueryItem("record_type", record.type);
+        params.addQueryItem("ttl", QString::number(ttl));
+    }
+
+    ManagedReply *reply = call(ddns ? "Record.Ddns" : "Record.Modify", params);
+    connect(reply, &ManagedReply::finished, this, [this, reply, record, fromCache, ttl]() {
+        if (isStale(reply)) {
+            return;
+        }
+        if (reply->error() != QNetworkReply::NoError) {
+            finishRecord(record, false, QString("Update record error: %1").arg(reply->errorString()));
+            return;
+        }
+
+        QJsonObject jsonObj = QJsonDocument::fromJson(reply->readAll()).object();
+        const QString code = statusCode(jsonObj);
+
+        // 缓存的记录已被删除，重新查询
+        if (fromCache && code == CODE_BAD_RECORD_ID) {
+            recordIds_.remove(recordKey(record));
+            listRecord(record);
+            return;
+        }
+        if (code != CODE_OK) {
+            finishRecord(record, false, QString("Update record error: %1").arg(dnspodError(jsonObj)));
+            return;
+        }
+
+        recordIds_[recordKey(record)].ttl = ttl;
+        finishRecord(record, true, "updated");
+    });
+}
@@ -0,0 +1,52 @@
+#ifndef DNSPOD_H
+#define DNSPOD_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QUrlQuery>
+#include <QJsonObject>
+
+#include "dnsprovider.h"
+
+// DNSPod（腾讯云解析）旧版 API，A 记录走专用的 Record.Ddns 接口
+class DnsPod : public DnsProvider
+{
+    Q_OBJECT
+public:
+    DnsPod(RequestManager *requestManager);
+
+    QString name() const override { return "DNSPod"; }
+    bool loadConfig(const QJsonObject &config, QString &error) override;
+
+    void updateDnsRecords(const QList<DnsRecord> &records) override;
+
+private:
+    // 缓存的记录：ID 以及上次写入的 TTL
+    struct CachedRecord
+    {
+        QString id;
+        int ttl = 0;
+    };
+
+    ManagedReply *call(const QString &action, const QUrlQuery &params);
+
+    static QString recordKey(const DnsRecord &record) { return record.type + " " + record.name; }
+    void listRecord(const DnsRecord &record);
+    void createRecord(const DnsRecord &record);
+    void writeRecord(const CachedRecord &cached, const DnsRecord &record, bool fromCache);
+    void finishRecord(const DnsRecord &record, bool success, const QString &message);
+
+private:
+    QString endpoint_;
+    QString token_;
+    QString domain_;
+
+    QHash<QString, CachedRecord> recordIds_;
+
+    int pending_ = 0;
+    bool success_ = true;
+    QStringList messages_;
+};
+
+#endif // DNSPOD_H
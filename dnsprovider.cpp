@@ -0,0 +1,113 @@
+#include "dnsprovider.h"
+#include "cloudflare.h"
+#include "aliyun.h"
+#include "dnspod.h"
+#include "duckdns.h"
+#include "mockprovider.h"
+#include "timerwheel.h"
+
+#include <QDebug>
+
+DnsProvider *DnsProvider::create(const QString &name, RequestManager *requestManager, QObject *parent)
+{
+    DnsProvider *provider = nullptr;
+    if (name == "Cloudflare") {
+        provider = new Cloudflare(requestManager);
+    } else if (name == "Aliyun") {
+        provider = new Aliyun(requestManager);
+    } else if (name == "DNSPod") {
+        provider = new DnsPod(requestManager);
+    } else if (name == "DuckDNS") {
+        provider = new DuckDns(requestManager);
+    } else if (name == "Mock") {
+        provider = new MockProvider(requestManager);
+    }
+
+    if (provider) {
+        provider->setParent(parent);
+    }
+    return provider;
+}
+
+void DnsProvider::beginCycle(quint64 cycle, const QDeadlineTimer &deadline)
+{
+    if (!inFlight_.isEmpty()) {
+        abortCycle();
+    }
+    cycle_ = cycle;
+    deadline_ = deadline;
+    running_ = 0;
+    waiting_.clear();
+}
+
+void DnsProvider::abortCycle()
+{
+    // 先作废轮次编号，abort() 同步触发的 finished 会被识别为过期
+    const quint64 aborted = cycle_;
+    cycle_ = 0;
+    running_ = 0;
+    waiting_.clear();
+
+    const QList<QPointer<ManagedReply>> replies = inFlight_;
+    inFlight_.clear();
+    for (const QPointer<ManagedReply> &reply : replies) {
+        if (reply && reply->isRunning()) {
+            qInfo() << QString("%1: abort request of cycle %2: %3")
+                           .arg(name())
+                           .arg(aborted)
+                           .arg(reply->url().toString(QUrl::RemoveQuery));
+            reply->abort();
+        }
+    }
+}
+
+ManagedReply *DnsProvider::trackReply(ManagedReply *reply)
+{
+    // 句柄的释放由 RequestManager 负责
+    reply->setProperty("cycle", cycle_);
+    inFlight_.append(QPointer<ManagedReply>(reply));
+
+    // 超时由整轮的截止时间决定，而不是每个请求固定的时长
+    TimerWheel::TimerId timeout = 0;
+    if (!deadline_.isForever()) {
+        int remaining = int(qMax<qint64>(0, deadline_.remainingTime()));
+        timeout = TimerWheel::getInstance().schedule(remaining, reply, [reply]() {
+            if (reply->isRunning()) {
+                qWarning() << "cycle deadline exceeded:" << reply->url().toString(QUrl::RemoveQuery);
+                reply->abort();
+            }
+        });
+    }
+
+    connect(reply, &ManagedReply::finished, this, [this, reply, timeout]() {
+        inFlight_.removeAll(QPointer<ManagedReply>(reply));
+        TimerWheel::getInstance().cancel(timeout);
+    });
+    return reply;
+}
+
+bool DnsProvider::isStale(const ManagedReply *reply) const
+{
+    return cycle_ == 0 || reply->property("cycle").toULongLong() != cycle_;
+}
+
+void DnsProvider::runLimited(std::function<void()> operation)
+{
+    if (maxConcurrent_ > 0 && running_ >= maxConcurrent_) {
+        waiting_.append(operation);
+        return;
+    }
+    ++running_;
+    operation();
+}
+
+void DnsProvider::releaseSlot()
+{
+    if (running_ > 0) {
+        --running_;
+    }
+    while (!waiting_.isEmpty() && (maxConcurrent_ <= 0 || running_ < maxConcurrent_)) {
+        ++running_;
+        waiting_.takeFirst()();
+    }
+}
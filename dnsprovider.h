@@ -0,0 +1,84 @@
+#ifndef DNSPROVIDER_H
+#define DNSPROVIDER_H
+
+#include <QObject>
+#include <QString>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QDeadlineTimer>
+#include <QPointer>
+#include <QList>
+#include <functional>
+
+#include "requestmanager.h"
+
+// 一条待写入的记录，name 为不含域名的记录名
+struct DnsRecord
+{
+    QString type;
+    QString name;
+    QString content;
+    // 故障切换、出口等附加记录，只能按名称写入，不能当作默认地址
+    bool extra = false;
+};
+
+class DnsProvider : public QObject
+{
+    Q_OBJECT
+public:
+    DnsProvider(RequestManager *requestManager, QObject *parent = nullptr)
+        : QObject(parent), requestManager_(requestManager) {};
+    virtual ~DnsProvider() = default;
+
+    // 根据服务商名称创建实例，未支持的服务商返回 nullptr
+    static DnsProvider *create(const QString &name, RequestManager *requestManager,
+                               QObject *parent = nullptr);
+
+    virtual QString name() const = 0;
+    virtual bool loadConfig(const QJsonObject &config, QString &error) = 0;
+
+    // 异步更新一组记录，服务商尽量合并为批量请求，完成后发出 updateFinished
+    virtual void updateDnsRecords(const QList<DnsRecord> &records) = 0;
+
+    // 能否按记录名单独写入记录；不能的服务商不参与只写部分记录的更新
+    virtual bool addressesRecordsByName() const { return true; }
+
+    // 开始新一轮更新，之后发出的请求都带上该轮的编号和截止时间
+    void beginCycle(quint64 cycle, const QDeadlineTimer &deadline);
+    // 中止当前轮次所有未完成的请求，其结果将被丢弃
+    void abortCycle();
+    quint64 cycle() const { return cycle_; }
+
+    // 写入记录时使用的 TTL（秒），1 表示自动
+    void setRecordTtl(int ttl) { ttl_ = ttl; }
+
+signals:
+    void updateFinished(bool success, const QString &message);
+
+protected:
+    // 登记请求：记录所属轮次，按剩余预算设置超时
+    ManagedReply *trackReply(ManagedReply *reply);
+    // 请求是否属于已被取代或中止的轮次
+    bool isStale(const ManagedReply *reply) const;
+
+    // 限制同时进行的记录操作数，超出的排队等待，0 表示不限制
+    void setMaxConcurrent(int count) { maxConcurrent_ = count; }
+    void runLimited(std::function<void()> operation);
+    // 一个受限操作（包括其后续请求）已完成
+    void releaseSlot();
+
+protected:
+    RequestManager *requestManager_;
+    int ttl_ = 1;
+
+private:
+    quint64 cycle_ = 0;
+    QDeadlineTimer deadline_ = QDeadlineTimer(QDeadlineTimer::Forever);
+    QList<QPointer<ManagedReply>> inFlight_;
+
+    int maxConcurrent_ = 0;
+    int running_ = 0;
+    QList<std::function<void()>> waiting_;
+};
+
+#endif // DNSPROVIDER_H
@@ -0,0 +1,204 @@
+#include "duckdns.h"
+
+#include <QJsonArray>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QSet>
+
+#include <algorithm>
+
+// 单个请求携带的子域名上限，避免 URL 过长
+static const int MAX_DOMAINS_PER_REQUEST = 100;
+
+QStringList DuckDns::parseDomains(const QString &domains)
+{
+    QStringList subdomains;
+    const QStringList items = domains.split(",", Qt::SkipEmptyParts);
+    for (QString item : items) {
+        item = item.trimmed().toLower();
+        if (item.endsWith(".duckdns.org")) {
+            item.chop(QString(".duckdns.org").size());
+        }
+        // DuckDNS 只接受一级子域名
+        item = item.section(".", -1);
+        if (!item.isEmpty() && !subdomains.contains(item)) {
+            subdomains.append(item);
+        }
+    }
+    return subdomains;
+}
+
+bool DuckDns::loadConfig(const QJsonObject &config, QString &error)
+{
+    QList<QJsonObject> entries;
+    entries.append(config);
+    const QJsonArray accounts = config["accounts"].toArray();
+    for (const QJsonValue &account : accounts) {
+        entries.append(account.toObject());
+    }
+
+    // 相同 token 的子域名合并到同一组
+    QList<Account> grouped;
+    for (const QJsonObject &entry : std::as_const(entries)) {
+        QString token = entry["token"].toString().trimmed();
+        QStringList domains = parseDomains(entry["domain"].toString());
+        if (token.isEmpty() || domains.isEmpty()) {
+            continue;
+        }
+
+        auto it = std::find_if(grouped.begin(), grouped.end(), [&token](const Account &a) {
+            return a.token == token;
+        });
+        if (it == grouped.end()) {
+            grouped.append({token, domains});
+            continue;
+        }
+        for (const QString &domain : std::as_const(domains)) {
+            if (!it->domains.contains(domain)) {
+                it->domains.append(domain);
+            }
+        }
+    }
+
+    if (grouped.isEmpty()) {
+        error = "Please fill in all DuckDNS settings";
+        return false;
+    }
+
+    accounts_ = grouped;
+    return true;
+}
+
+void DuckDns::updateDnsRecords(const QList<DnsRecord> &records)
+{
+    pending_ = 0;
+    success_ = true;
+    messages_.clear();
+
+    // DuckDNS 直接使用配置中的子域名，每个地址族的第一条主记录作为默认地址；
+    // 名称与某个已配置子域名相同的记录（前缀委派推导、出口记录等）单独写入该子域名，
+    // 附加记录只按名称写入，不会成为默认地址
+    QSet<QString> configured;
+    for (const Account &account : std::as_const(accounts_)) {
+        for (const QString &domain : account.domains) {
+            configured.insert(domain);
+        }
+    }
+    QString ipv4;
+    QString ipv6;
+    QHash<QString, QString> ipv4Overrides;
+    QHash<QString, QString> ipv6Overrides;
+    for (const DnsRecord &record : records) {
+        if (record.type != "A" && record.type != "AAAA") {
+            continue;
+        }
+        const bool isIpv4 = record.type == "A";
+        QString &fallback = isIpv4 ? ipv4 : ipv6;
+        if (fallback.isEmpty() && !record.extra) {
+            fallback = record.content;
+        }
+        const QString subdomain = parseDomains(record.name).value(0);
+        if (configured.contains(subdomain)) {
+            (isIpv4 ? ipv4Overrides : ipv6Overrides).insert(subdomain, record.content);
+        }
+    }
+
+    if (ipv4.isEmpty() && ipv6.isEmpty()) {
+        emit updateFinished(true, "nothing to update");
+        return;
+    }
+
+    // 同一 token 下地址相同的子域名合并为一个请求
+    struct Request {
+        QString token;
+        QString ipv4;
+        QString ipv6;
+        QStringList domains;
+    };
+    QList<Request> requests;
+    for (const Account &account : std::as_const(accounts_)) {
+        QMap<QPair<QString, QString>, QStringList> byAddress;
+        for (const QString &domain : account.domains) {
+            byAddress[qMakePair(ipv4Overrides.value(domain, ipv4), ipv6Overrides.value(domain, ipv6))]
+                .append(domain);
+        }
+        for (auto it = byAddress.cbegin(); it != byAddress.cend(); ++it) {
+            for (int i = 0; i < it.value().size(); i += MAX_DOMAINS_PER_REQUEST) {
+                requests.append({account.token, it.key().first, it.key().second,
+                                 it.value().mid(i, MAX_DOMAINS_PER_REQUEST)});
+            }
+        }
+    }
+
+    pending_ = requests.size();
+    for (const Request &request : std::as_const(requests)) {
+        sendUpdate(request.token, request.domains, request.ipv4, request.ipv6);
+    }
+}
+
+void DuckDns::sendUpdate(const QString &token, const QStringList &domains,
+                         const QString &ipv4, const QString &ipv6)
+{
+    QUrlQuery query;
+    query.addQueryItem("domains", domains.join(","));
+    query.addQueryItem("token", token);
+    // 未启用的地址族不传，避免清空或覆盖对应记录
+    if (!ipv4.isEmpty()) {
+        query.addQueryItem("ip", ipv4);
+    }
+    if (!ipv6.isEmpty()) {
+        query.addQueryItem("ipv6", ipv6);
+    }
+    query.addQueryItem("verbose", "true");
+
+    QUrl url("https://www.duckdns.org/update");
+    url.setQuery(query);
+
+    qInfo() << QString("DuckDNS update %1 domain(s): %2").arg(domains.size()).arg(domains.join(","));
+
+    ManagedReply *reply = trackReply(requestManager_->get(QNetworkRequest(url)));
+
+    connect(reply, &ManagedReply::finished, this, [this, reply, domains]() {
+        if (isStale(reply)) {
+            return;
+        }
+        handleUpdateReply(reply, domains);
+    });
+}
+
+void DuckDns::handleUpdateReply(ManagedReply *reply, const QStringList &domains)
+{
+    if (reply->error() != QNetworkReply::NoError) {
+        finishRequest(false, QString("%1: %2").arg(domains.join(","), reply->errorString()));
+        return;
+    }
+
+    // verbose 响应格式: OK|KO \n ipv4 \n ipv6 \n UPDATED|NOCHANGE
+    const QString response = QString::fromUtf8(reply->readAll()).trimmed();
+    const QStringList lines = response.split("\n");
+    const QString status = lines.value(0).trimmed();
+    qDebug() << "DuckDNS update response:" << response;
+
+    if (status == "OK") {
+        QString detail = lines.value(3).trimmed() == "NOCHANGE" ? "unchanged" : "updated";
+        finishRequest(true, QString("%1: %2").arg(domains.join(","), detail));
+    } else if (status == "KO") {
+        finishRequest(false, QString("%1: rejected (bad token or domain)").arg(domains.join(",")));
+    } else {
+        finishRequest(false, QString("%1: unexpected response '%2'").arg(domains.join(","), status));
+    }
+}
+
+void DuckDns::finishRequest(bool success, const QString &message)
+{
+    messages_.append(message);
+    success_ = success_ && success;
+
+    if (--pending_ > 0) {
+        return;
+    }
+    emit updateFinished(success_, messages_.join("; "));
+}
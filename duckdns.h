@@ -0,0 +1,45 @@
+#ifndef DUCKDNS_H
+#define DUCKDNS_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QJsonObject>
+
+#include "dnsprovider.h"
+
+class DuckDns : public DnsProvider
+{
+    Q_OBJECT
+public:
+    DuckDns(RequestManager *requestManager) : DnsProvider(requestManager) {};
+
+    QString name() const override { return "DuckDNS"; }
+    bool loadConfig(const QJsonObject &config, QString &error) override;
+
+    void updateDnsRecords(const QList<DnsRecord> &records) override;
+    // 只能按配置的子域名整体写入
+    bool addressesRecordsByName() const override { return false; }
+
+private:
+    struct Account {
+        QString token;
+        QStringList domains;
+    };
+
+    static QStringList parseDomains(const QString &domains);
+    void sendUpdate(const QString &token, const QStringList &domains,
+                    const QString &ipv4, const QString &ipv6);
+    void handleUpdateReply(ManagedReply *reply, const QStringList &domains);
+    void finishRequest(bool success, const QString &message);
+
+private:
+    // 按 token 分组的子域名
+    QList<Account> accounts_;
+
+    int pending_ = 0;
+    bool success_ = true;
+    QStringList messages_;
+};
+
+#endif // DUCKDNS_H
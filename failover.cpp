@@ -0,0 +1,395 @@
+#include "failover.h"
+#include "clock.h"
+
+#include <QTcpSocket>
+#include <QSslSocket>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QSharedPointer>
+#include <QDebug>
+
+Failover::Failover(RequestManager *requestManager, QObject *parent)
+    : QObject(parent)
+    , requestManager_(requestManager)
+{
+}
+
+void Failover::loadConfig(const QJsonArray &config)
+{
+    const bool wasRunning = running_;
+    stop();
+    // 保留记录和地址未变的探测状态，避免保存设置后重新从头探测、活动目标回到未知
+    const QList<Group> previous = groups_;
+    for (const Group &group : previous) {
+        delete group.timer;
+    }
+    groups_.clear();
+    ++generation_;
+
+    for (const QJsonValue &value : config) {
+        const QJsonObject object = value.toObject();
+        Group group;
+        group.record = object["record"].toString();
+
+        // 配置单位为秒
+        group.interval = int(object["interval"].toDouble(10) * 1000);
+        group.fastInterval = int(object["fast_interval"].toDouble(1) * 1000);
+        group.timeout = int(object["timeout"].toDouble(3) * 1000);
+        group.failThreshold = qMax(1, object["fail_threshold"].toInt(3));
+        group.recoverThreshold = qMax(1, object["recover_threshold"].toInt(3));
+        group.failbackHold = qint64(object["failback_hold"].toDouble(120) * 1000);
+
+        for (const QJsonValue &entry : object["candidates"].toArray()) {
+            const QJsonObject item = entry.toObject();
+            Candidate candidate;
+            candidate.address = item["address"].toString();
+
+            QHostAddress address;
+            if (!address.setAddress(candidate.address)) {
+                qWarning() << QString("failover %1: invalid candidate address %2").arg(group.record, candidate.address);
+                continue;
+            }
+            const QString type = address.protocol() == QAbstractSocket::IPv6Protocol ? "AAAA" : "A";
+            // 同一组的候选必须属于同一地址族
+            if (group.type.isEmpty()) {
+                group.type = type;
+            } else if (group.type != type) {
+                qWarning() << QString("failover %1: %2 is not an %3 address, skipped")
+                                  .arg(group.record, candidate.address, group.type);
+                continue;
+            }
+
+            const QString probe = item["probe"].toString("tcp");
+            if (probe == "https" && item["host"].toString().isEmpty()) {
+                // 证书按名称签发，只有地址无法校验
+                qWarning() << QString("failover %1: https probe of %2 needs a host, skipped")
+                                  .arg(group.record, candidate.address);
+                continue;
+            }
+            if (probe == "http" || probe == "https") {
+                candidate.kind = HttpProbe;
+                candidate.url.setScheme(probe);
+                candidate.url.setHost(address.toString());
+                candidate.url.setPort(item["port"].toInt(probe == "https" ? 443 : 80));
+                candidate.url.setPath(item["path"].toString("/"));
+                candidate.host = item["host"].toString();
+            } else if (probe == "ping") {
+                candidate.kind = PingProbe;
+                candidate.port = quint16(item["port"].toInt(80));
+            } else {
+                candidate.kind = TcpProbe;
+                candidate.port = quint16(item["port"].toInt(80));
+            }
+            group.candidates.append(candidate);
+        }
+
+        if (group.record.isEmpty() || group.candidates.isEmpty()) {
+            qWarning() << QString("failover group %1 has no usable candidates, ignored").arg(group.record);
+            continue;
+        }
+
+        for (const Group &old : previous) {
+            if (old.record == group.record && old.type == group.type) {
+                carryOver(old, group);
+                break;
+            }
+        }
+
+        group.timer = new WheelTimer(this);
+        group.timer->setSingleShot(true);
+        const int index = groups_.size();
+        connect(group.timer, &WheelTimer::timeout, this, [this, index]() { probeGroup(index); });
+        groups_.append(group);
+    }
+
+    if (wasRunning) {
+        start();
+    }
+}
+
+void Failover::carryOver(const Group &old, Group &group)
+{
+    for (int i = 0; i < group.candidates.size(); ++i) {
+        Candidate &candidate = group.candidates[i];
+        for (int j = 0; j < old.candidates.size(); ++j) {
+            const Candidate &before = old.candidates.at(j);
+            // 探测方式变了，之前的结果不再适用
+            if (before.address != candidate.address || before.kind != candidate.kind
+                || before.port != candidate.port || before.url != candidate.url || before.host != candidate.host) {
+                continue;
+            }
+            candidate.known = before.known;
+            candidate.healthy = before.healthy;
+            candidate.successes = before.successes;
+            candidate.failures = before.failures;
+            candidate.healthySince = before.healthySince;
+            if (j == old.active) {
+                group.active = i;
+            }
+            break;
+        }
+    }
+}
+
+void Failover::start()
+{
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    for (int i = 0; i < groups_.size(); ++i) {
+        if (groups_.at(i).pending == 0) {
+            probeGroup(i);
+        }
+    }
+}
+
+void Failover::stop()
+{
+    running_ = false;
+    for (const Group &group : std::as_const(groups_)) {
+        group.timer->stop();
+    }
+}
+
+QList<DnsRecord> Failover::records() const
+{
+    QList<DnsRecord> records;
+    for (const Group &group : groups_) {
+        if (group.active >= 0) {
+            records.append({group.type, group.record, group.candidates.at(group.active).address});
+        }
+    }
+    return records;
+}
+
+bool Failover::isSettled() const
+{
+    for (const Group &group : groups_) {
+        if (group.pending > 0) {
+            return false;
+        }
+        for (const Candidate &candidate : group.candidates) {
+            if (!candidate.known) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+QStringList Failover::recordNames() const
+{
+    QStringList names;
+    for (const Group &group : groups_) {
+        names.append(group.record);
+    }
+    return names;
+}
+
+void Failover::probeGroup(int index)
+{
+    Group &group = groups_[index];
+    const quint64 generation = generation_;
+
+    // 同一组的候选同时探测，一轮耗时不超过单次超时
+    group.pending = group.candidates.size();
+    for (int i = 0; i < group.candidates.size(); ++i) {
+        group.candidates[i].probing = true;
+        probe(group.candidates.at(i), group.timeout, [this, generation, index, i](bool success) {
+            if (generation == generation_) {
+                onProbeResult(index, i, success);
+            }
+        });
+    }
+}
+
+void Failover::probe(const Candidate &candidate, int timeout, std::function<void(bool)> done)
+{
+    if (candidate.kind == HttpProbe) {
+        probeHttp(candidate, timeout, done);
+    } else {
+        probeTcp(candidate, timeout, done);
+    }
+}
+
+void Failover::probeTcp(const Candidate &candidate, int timeout, std::function<void(bool)> done)
+{
+    QTcpSocket *socket = new QTcpSocket(this);
+    // 连接成功、出错和超时只取最先发生的一个
+    QSharedPointer<bool> settled(new bool(false));
+    auto finish = [socket, settled, done](bool success) {
+        if (*settled) {
+            return;
+        }
+        *settled = true;
+        socket->disconnect();
+        socket->abort();
+        socket->deleteLater();
+        done(success);
+    };
+
+    const ProbeKind kind = candidate.kind;
+    connect(socket, &QTcpSocket::connected, this, [finish]() { finish(true); });
+    connect(socket, &QTcpSocket::errorOccurred, this, [finish, kind](QAbstractSocket::SocketError error) {
+        // 对端回复 RST 说明主机在线，只是端口未开放
+        finish(kind == PingProbe && error == QAbstractSocket::ConnectionRefusedError);
+    });
+    TimerWheel::getInstance().schedule(timeout, socket, [finish]() { finish(false); });
+
+    socket->connectToHost(QHostAddress(candidate.address), candidate.port);
+}
+
+void Failover::probeHttp(const Candidate &candidate, int timeout, std::function<void(bool)> done)
+{
+    if (candidate.url.scheme() == "https") {
+        probeHttps(candidate, timeout, done);
+        return;
+    }
+
+    QNetworkRequest request(candidate.url);
+    request.setTransferTimeout(timeout);
+    if (!candidate.host.isEmpty()) {
+        request.setRawHeader("Host", candidate.host.toUtf8());
+    }
+
+    ManagedReply *reply = requestManager_->get(request);
+    connect(reply, &ManagedReply::finished, this, [reply, done]() {
+        const int status = reply->httpStatus();
+        done(reply->error() == QNetworkReply::NoError && status >= 200 && status < 400);
+    });
+}
+
+void Failover::probeHttps(const Candidate &candidate, int timeout, std::function<void(bool)> done)
+{
+    // 连接到候选地址，但 SNI 和证书校验使用配置的主机名；
+    // QNetworkAccessManager 做不到这一点，这里直接发送请求
+    QSslSocket *socket = new QSslSocket(this);
+    QSharedPointer<QByteArray> response(new QByteArray);
+    QSharedPointer<bool> settled(new bool(false));
+    auto finish = [socket, settled, done](bool success) {
+        if (*settled) {
+            return;
+        }
+        *settled = true;
+        socket->disconnect();
+        socket->abort();
+        socket->deleteLater();
+        done(success);
+    };
+
+    const QByteArray request = QString("GET %1 HTTP/1.0\r\nHost: %2\r\nUser-Agent: ddns-qt/0.1\r\n\r\n")
+                                   .arg(candidate.url.path(QUrl::FullyEncoded), candidate.host)
+                                   .toLatin1();
+    connect(socket, &QSslSocket::encrypted, this, [socket, request]() {
+        socket->write(request);
+    });
+    connect(socket, &QSslSocket::readyRead, this, [socket, response, finish]() {
+        response->append(socket->readAll());
+        // 只需要状态行
+        const qsizetype end = response->indexOf("\r\n");
+        if (end < 0) {
+            return;
+        }
+        const QList<QByteArray> status = response->left(end).split(' ');
+        const int code = status.size() >= 2 ? status.at(1).toInt() : 0;
+        finish(code >= 200 && code < 400);
+    });
+    connect(socket, &QSslSocket::errorOccurred, this, [finish]() { finish(false); });
+    TimerWheel::getInstance().schedule(timeout, socket, [finish]() { finish(false); });
+
+    socket->connectToHostEncrypted(candidate.address, quint16(candidate.url.port(443)), candidate.host);
+}
+
+void Failover::onProbeResult(int index, int candidateIndex, bool success)
+{
+    Group &group = groups_[index];
+    Candidate &candidate = group.candidates[candidateIndex];
+    candidate.probing = false;
+    group.pending--;
+
+    // 首次结果直接采用，之后的状态变化需要连续达到阈值
+    if (success) {
+        candidate.successes++;
+        candidate.failures = 0;
+        if (!candidate.known || (!candidate.healthy && candidate.successes >= group.recoverThreshold)) {
+            if (candidate.known) {
+                qInfo() << QString("failover %1: %2 recovered").arg(group.record, candidate.address);
+            }
+            candidate.healthy = true;
+            candidate.healthySince = Clock::elapsed();
+        }
+    } else {
+        candidate.failures++;
+        candidate.successes = 0;
+        if (!candidate.known || (candidate.healthy && candidate.failures >= group.failThreshold)) {
+            qWarning() << QString("failover %1: %2 is down").arg(group.record, candidate.address);
+            candidate.healthy = false;
+        }
+    }
+    candidate.known = true;
+
+    evaluate(index);
+
+    if (group.pending > 0) {
+        return;
+    }
+    emit roundFinished(group.record);
+    if (!running_) {
+        return;
+    }
+    // 活动目标探测失败时加快下一轮，尽快确认是否需要切换
+    const bool suspect = group.active >= 0 && group.candidates.at(group.active).failures > 0;
+    group.timer->start(suspect ? group.fastInterval : group.interval);
+}
+
+void Failover::evaluate(int index)
+{
+    Group &group = groups_[index];
+
+    int best = -1;
+    for (int i = 0; i < group.candidates.size(); ++i) {
+        if (group.candidates.at(i).healthy) {
+            best = i;
+            break;
+        }
+    }
+
+    // 首轮探测全部返回后才确定活动目标
+    if (group.active < 0) {
+        if (group.pending > 0) {
+            return;
+        }
+        if (best < 0) {
+            qWarning() << QString("failover %1: no healthy candidate").arg(group.record);
+            return;
+        }
+        activate(group, best);
+        return;
+    }
+
+    // 全部不可用时保持原记录，不写入同样不可用的地址
+    if (best < 0 || best == group.active) {
+        return;
+    }
+
+    if (!group.candidates.at(group.active).healthy) {
+        activate(group, best);
+        return;
+    }
+
+    // 活动目标正常时，更高优先级的候选需要稳定一段时间才切回
+    if (best < group.active && Clock::elapsed() - group.candidates.at(best).healthySince >= group.failbackHold) {
+        activate(group, best);
+    }
+}
+
+void Failover::activate(Group &group, int index)
+{
+    const QString previous = group.active >= 0 ? group.candidates.at(group.active).address : QString();
+    const QString address = group.candidates.at(index).address;
+    qInfo() << QString("failover %1: %2 -> %3").arg(group.record, previous.isEmpty() ? "(none)" : previous, address);
+
+    group.active = index;
+    emit targetChanged(group.record, address);
+}
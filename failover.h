@@ -0,0 +1,105 @@
+#ifndef FAILOVER_H
+#define FAILOVER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QUrl>
+#include <QJsonArray>
+#include <functional>
+
+#include "dnsprovider.h"
+#include "requestmanager.h"
+#include "timerwheel.h"
+
+// 故障切换：记录指向按优先级排列的候选地址中当前健康的一个
+//
+// 每组的全部候选并行探测；活动目标连续失败达到阈值后立即切到优先级最高的健康候选，
+// 失败期间加快探测频率。候选恢复需要连续成功若干次，切回更高优先级的候选还要
+// 再等待一段保持时间，避免在两个目标之间来回切换。
+class Failover : public QObject
+{
+    Q_OBJECT
+public:
+    enum ProbeKind {
+        TcpProbe,   // TCP 连接成功即健康
+        HttpProbe,  // HTTP(S) 返回 2xx/3xx 即健康，HTTPS 按 host 校验证书
+        PingProbe,  // 主机有响应即健康（连接被拒绝也算）
+    };
+
+    struct Candidate {
+        QString address;
+        ProbeKind kind = TcpProbe;
+        quint16 port = 0;
+        QUrl url;
+        QString host;
+
+        bool known = false;     // 已有探测结果
+        bool healthy = false;
+        int successes = 0;      // 连续成功次数
+        int failures = 0;       // 连续失败次数
+        qint64 healthySince = 0;
+        bool probing = false;
+    };
+
+    struct Group {
+        QString record;
+        QString type;
+        QList<Candidate> candidates;
+        int active = -1;        // 尚未完成首轮探测时为 -1
+        int pending = 0;        // 本轮未返回的探测数
+
+        // 参数单位均为毫秒
+        int interval = 10000;
+        int fastInterval = 1000;
+        int timeout = 3000;
+        int failThreshold = 3;
+        int recoverThreshold = 3;
+        qint64 failbackHold = 120000;
+
+        WheelTimer *timer = nullptr;
+    };
+
+    explicit Failover(RequestManager *requestManager, QObject *parent = nullptr);
+
+    void loadConfig(const QJsonArray &config);
+    void start();
+    void stop();
+    bool isRunning() const { return running_; }
+    bool isEmpty() const { return groups_.isEmpty(); }
+    // 每组都已完成至少一轮探测
+    bool isSettled() const;
+
+    // 各组当前活动目标对应的记录，未完成首轮探测的组不包含在内
+    QList<DnsRecord> records() const;
+    QStringList recordNames() const;
+    const QList<Group> &groups() const { return groups_; }
+
+signals:
+    void targetChanged(const QString &record, const QString &address);
+    // 一组的一轮探测全部返回
+    void roundFinished(const QString &record);
+
+private:
+    void probeGroup(int group);
+    void probe(const Candidate &candidate, int timeout, std::function<void(bool)> done);
+    void probeTcp(const Candidate &candidate, int timeout, std::function<void(bool)> done);
+    void probeHttp(const Candidate &candidate, int timeout, std::function<void(bool)> done);
+    void probeHttps(const Candidate &candidate, int timeout, std::function<void(bool)> done);
+    void onProbeResult(int group, int index, bool success);
+    // 按健康状态选择活动目标
+    void evaluate(int group);
+    void activate(Group &group, int index);
+    // 沿用旧组中同一地址、同一探测方式候选的状态
+    static void carryOver(const Group &old, Group &group);
+
+private:
+    RequestManager *requestManager_;
+    QList<Group> groups_;
+    // 重新加载配置后，旧探测的结果不再计入
+    quint64 generation_ = 0;
+    bool running_ = false;
+};
+
+#endif // FAILOVER_H
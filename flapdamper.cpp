@@ -0,0 +1,161 @@
+#include "flapdamper.h"
+#include "clock.h"
+
+#include <QDebug>
+#include <QtMath>
+
+FlapDamper::FlapDamper(QObject *parent)
+    : QObject(parent)
+    , ipv4Timer_(new WheelTimer(this))
+    , ipv6Timer_(new WheelTimer(this))
+{
+    ipv4Timer_->setSingleShot(true);
+    ipv6Timer_->setSingleShot(true);
+    connect(ipv4Timer_, &WheelTimer::timeout, this, [this]() { evaluate(true); });
+    connect(ipv6Timer_, &WheelTimer::timeout, this, [this]() { evaluate(false); });
+}
+
+void FlapDamper::loadConfig(const QJsonObject &config)
+{
+    // 配置单位为秒
+    stableWindow_ = qint64(config["stable_window"].toDouble(30) * 1000);
+    halfLife_ = qint64(config["half_life"].toDouble(300) * 1000);
+    maxSuppress_ = qint64(config["max_suppress"].toDouble(3600) * 1000);
+    flapPenalty_ = config["penalty"].toDouble(1000);
+    suppressThreshold_ = config["suppress_threshold"].toDouble(2000);
+    reuseThreshold_ = config["reuse_threshold"].toDouble(750);
+}
+
+double FlapDamper::decayedPenalty(const State &state) const
+{
+    if (state.penalty <= 0 || halfLife_ <= 0) {
+        return 0;
+    }
+    double elapsed = double(Clock::elapsed() - state.penaltyUpdated);
+    return state.penalty * qPow(0.5, elapsed / double(halfLife_));
+}
+
+void FlapDamper::releaseSuppression(State &state) const
+{
+    if (state.suppressed && decayedPenalty(state) <= reuseThreshold_) {
+        state.suppressed = false;
+    }
+}
+
+void FlapDamper::addPenalty(State &state)
+{
+    // 回到原值后不再有待评估的候选，抑制状态只能在下一次变化时解除
+    releaseSuppression(state);
+    state.penalty = decayedPenalty(state) + flapPenalty_;
+    state.penaltyUpdated = Clock::elapsed();
+    state.flaps++;
+    if (state.penalty >= suppressThreshold_) {
+        state.suppressed = true;
+    }
+}
+
+void FlapDamper::observe(bool isIpv4, const QString &address)
+{
+    State &state = stateOf(isIpv4);
+
+    // 首次发现的地址直接提交
+    if (state.committed.isEmpty() && state.candidate.isEmpty()) {
+        state.committed = address;
+        emit stateChanged(isIpv4);
+        emit addressStable(isIpv4, address);
+        return;
+    }
+
+    if (address == state.candidate) {
+        return;
+    }
+
+    if (address == state.committed) {
+        if (state.candidate.isEmpty()) {
+            return;
+        }
+        // 在稳定窗口内又回到原值，合并为无变化
+        qInfo() << QString("%1 flapped back to %2").arg(isIpv4 ? "IPv4" : "IPv6").arg(address);
+        state.candidate.clear();
+        addPenalty(state);
+        timerOf(isIpv4)->stop();
+        emit stateChanged(isIpv4);
+        return;
+    }
+
+    state.candidate = address;
+    state.candidateSince = Clock::elapsed();
+    addPenalty(state);
+    schedule(isIpv4);
+    emit stateChanged(isIpv4);
+}
+
+void FlapDamper::commit(bool isIpv4, const QString &address)
+{
+    State &state = stateOf(isIpv4);
+    if (state.committed == address && state.candidate.isEmpty()) {
+        return;
+    }
+    state.committed = address;
+    state.candidate.clear();
+    timerOf(isIpv4)->stop();
+    emit stateChanged(isIpv4);
+}
+
+void FlapDamper::schedule(bool isIpv4)
+{
+    State &state = stateOf(isIpv4);
+    const qint64 waited = Clock::elapsed() - state.candidateSince;
+    qint64 delay = stableWindow_ - waited;
+
+    // 处于抑制状态时，等惩罚值衰减到复用阈值以下（不超过最长抑制时间）
+    double penalty = decayedPenalty(state);
+    if (state.suppressed && penalty > reuseThreshold_) {
+        qint64 reuseDelay = qint64(double(halfLife_) * std::log2(penalty / reuseThreshold_));
+        reuseDelay = qMin(reuseDelay, maxSuppress_ - waited);
+        delay = qMax(delay, reuseDelay);
+    }
+
+    timerOf(isIpv4)->start(int(qMax<qint64>(0, delay)));
+}
+
+void FlapDamper::evaluate(bool isIpv4)
+{
+    State &state = stateOf(isIpv4);
+    if (state.candidate.isEmpty()) {
+        return;
+    }
+
+    const qint64 waited = Clock::elapsed() - state.candidateSince;
+    releaseSuppression(state);
+
+    if (waited < stableWindow_ || (state.suppressed && waited < maxSuppress_)) {
+        schedule(isIpv4);
+        emit stateChanged(isIpv4);
+        return;
+    }
+
+    state.committed = state.candidate;
+    state.candidate.clear();
+    qInfo() << QString("%1 stable at %2 after %3 s").arg(isIpv4 ? "IPv4" : "IPv6").arg(state.committed).arg(waited / 1000);
+    emit stateChanged(isIpv4);
+    emit addressStable(isIpv4, state.committed);
+}
+
+QString FlapDamper::describe(bool isIpv4) const
+{
+    const State &s = state(isIpv4);
+    const int penalty = int(decayedPenalty(s));
+
+    if (s.candidate.isEmpty()) {
+        return penalty > 0 ? QString("stable (penalty %1)").arg(penalty) : QString("stable");
+    }
+
+    const qint64 waited = (Clock::elapsed() - s.candidateSince) / 1000;
+    if (s.suppressed) {
+        return QString("damped: %1 held for %2 s (penalty %3, %4 flaps)")
+            .arg(s.candidate).arg(waited).arg(penalty).arg(s.flaps);
+    }
+    return QString("pending: %1 for %2/%3 s (penalty %4)")
+        .arg(s.candidate).arg(waited).arg(stableWindow_ / 1000).arg(penalty);
+}
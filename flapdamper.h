@@ -0,0 +1,63 @@
+#ifndef FLAPDAMPER_H
+#define FLAPDAMPER_H
+
+#include <QObject>
+#include <QString>
+#include <QJsonObject>
+#include "timerwheel.h"
+
+// 发现的地址先经过稳定窗口与抖动抑制，再进入更新流程
+class FlapDamper : public QObject
+{
+    Q_OBJECT
+public:
+    struct State {
+        QString committed;      // 已提交给更新流程的地址
+        QString candidate;      // 等待稳定的新地址
+        qint64 candidateSince = 0;
+        double penalty = 0;
+        qint64 penaltyUpdated = 0;
+        bool suppressed = false;
+        int flaps = 0;
+    };
+
+    explicit FlapDamper(QObject *parent = nullptr);
+
+    void loadConfig(const QJsonObject &config);
+    void observe(bool isIpv4, const QString &address);
+    // 从其他来源确认的地址直接作为已提交地址，放弃等待中的候选
+    void commit(bool isIpv4, const QString &address);
+
+    const State &state(bool isIpv4) const { return isIpv4 ? ipv4_ : ipv6_; }
+    QString describe(bool isIpv4) const;
+
+signals:
+    void addressStable(bool isIpv4, const QString &address);
+    void stateChanged(bool isIpv4);
+
+private:
+    State &stateOf(bool isIpv4) { return isIpv4 ? ipv4_ : ipv6_; }
+    WheelTimer *timerOf(bool isIpv4) { return isIpv4 ? ipv4Timer_ : ipv6Timer_; }
+    double decayedPenalty(const State &state) const;
+    // 惩罚值衰减到复用阈值以下时解除抑制
+    void releaseSuppression(State &state) const;
+    void addPenalty(State &state);
+    void schedule(bool isIpv4);
+    void evaluate(bool isIpv4);
+
+private:
+    State ipv4_;
+    State ipv6_;
+    WheelTimer *ipv4Timer_;
+    WheelTimer *ipv6Timer_;
+
+    // 参数单位均为毫秒
+    qint64 stableWindow_ = 30000;
+    qint64 halfLife_ = 300000;
+    qint64 maxSuppress_ = 3600000;
+    double flapPenalty_ = 1000;
+    double suppressThreshold_ = 2000;
+    double reuseThreshold_ = 750;
+};
+
+#endif // FLAPDAMPER_H
@@ -0,0 +1,269 @@
+#include "hostcoordinator.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QStandardPaths>
+#include <QDebug>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+static const QString SHARED_KEY = "ddns-qt-shared-state";
+// 共享内存大小，足够容纳地址和各服务商的结果
+static const int SHARED_SIZE = 64 * 1024;
+static const quint32 SHARED_MAGIC = 0x44444e53; // "DDNS"
+
+// 共享内存头部，之后紧跟 JSON 数据
+struct SharedHeader
+{
+    quint32 magic;
+    quint32 length;
+};
+
+// 当前用户的标识，共享内存和锁文件都只在同一用户的实例之间生效
+static QString userScope()
+{
+#ifdef Q_OS_UNIX
+    return QString::number(getuid());
+#else
+    return qEnvironmentVariable("USERNAME");
+#endif
+}
+
+// 锁文件放在用户自己的运行时目录，不与其他用户争用 /tmp 中的同名文件
+static QString lockDirectory()
+{
+    const QString runtime = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    return runtime.isEmpty() ? QDir::tempPath() : runtime;
+}
+
+HostCoordinator::HostCoordinator(QObject *parent)
+    : QObject(parent)
+    , memory_(QString("%1-%2").arg(SHARED_KEY, userScope()))
+{
+}
+
+HostCoordinator::~HostCoordinator()
+{
+    releaseAll();
+}
+
+void HostCoordinator::setEnabled(bool enabled)
+{
+    if (enabled_ == enabled) {
+        return;
+    }
+    enabled_ = enabled;
+    if (!enabled_) {
+        releaseAll();
+        if (memory_.isAttached()) {
+            memory_.detach();
+        }
+    }
+}
+
+QString HostCoordinator::updateLockName(const QString &provider, const QString &records)
+{
+    // 记录名可能包含不适合作为文件名的字符
+    const QByteArray hash = QCryptographicHash::hash((provider + "|" + records).toUtf8(), QCryptographicHash::Sha1);
+    return QString("update-%1-%2").arg(provider.toLower(), QString::fromLatin1(hash.toHex().left(12)));
+}
+
+bool HostCoordinator::acquire(const QString &name)
+{
+    if (isHeld(name)) {
+        return true;
+    }
+
+    QSharedPointer<QLockFile> lock(new QLockFile(QDir(lockDirectory()).filePath(QString("ddns-qt-%1-%2.lock").arg(userScope(), name))));
+    // 主实例长期持有锁；持有者进程退出后锁会被识别为失效
+    lock->setStaleLockTime(0);
+    if (!lock->tryLock(0)) {
+        return false;
+    }
+
+    qInfo() << QString("took over %1 for this host").arg(name);
+    locks_.insert(name, lock);
+    return true;
+}
+
+bool HostCoordinator::isHeld(const QString &name) const
+{
+    return locks_.contains(name);
+}
+
+void HostCoordinator::releaseAll()
+{
+    for (const QSharedPointer<QLockFile> &lock : std::as_const(locks_)) {
+        lock->unlock();
+    }
+    locks_.clear();
+}
+
+void HostCoordinator::releaseUpdates()
+{
+    for (auto it = locks_.begin(); it != locks_.end();) {
+        if (it.key().startsWith("update-")) {
+            qInfo() << QString("released %1 for this host").arg(it.key());
+            it.value()->unlock();
+            it = locks_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool HostCoordinator::acquireDiscovery()
+{
+    return acquire(discoveryLockName());
+}
+
+bool HostCoordinator::acquireUpdate(const QString &provider, const QString &records)
+{
+    return acquire(updateLockName(provider, records));
+}
+
+bool HostCoordinator::attach() const
+{
+    if (memory_.isAttached()) {
+        return true;
+    }
+    if (memory_.attach()) {
+        return true;
+    }
+    if (memory_.create(SHARED_SIZE)) {
+        // 新建的段内容未定义，先写入空头部
+        memory_.lock();
+        std::memset(memory_.data(), 0, sizeof(SharedHeader));
+        memory_.unlock();
+        return true;
+    }
+    // 另一个实例刚好先创建了
+    if (memory_.error() == QSharedMemory::AlreadyExists && memory_.attach()) {
+        return true;
+    }
+    qWarning() << "shared state unavailable:" << memory_.errorString();
+    return false;
+}
+
+QJsonObject HostCoordinator::parseLocked() const
+{
+    const SharedHeader *header = static_cast<const SharedHeader *>(memory_.constData());
+    if (header->magic != SHARED_MAGIC || header->length > quint32(memory_.size()) - sizeof(SharedHeader)) {
+        return QJsonObject();
+    }
+    const char *data = static_cast<const char *>(memory_.constData()) + sizeof(SharedHeader);
+    return QJsonDocument::fromJson(QByteArray(data, int(header->length))).object();
+}
+
+QJsonObject HostCoordinator::readShared() const
+{
+    if (!attach()) {
+        return QJsonObject();
+    }
+
+    memory_.lock();
+    const QJsonObject state = parseLocked();
+    memory_.unlock();
+    return state;
+}
+
+void HostCoordinator::updateShared(const std::function<void(QJsonObject &)> &update)
+{
+    if (!attach()) {
+        return;
+    }
+
+    // 读-改-写全程持有共享内存的锁，避免与其他实例的写入互相覆盖
+    memory_.lock();
+    QJsonObject state = parseLocked();
+    update(state);
+
+    const QByteArray json = QJsonDocument(state).toJson(QJsonDocument::Compact);
+    if (json.size() <= memory_.size() - int(sizeof(SharedHeader))) {
+        SharedHeader *header = static_cast<SharedHeader *>(memory_.data());
+        std::memcpy(static_cast<char *>(memory_.data()) + sizeof(SharedHeader), json.constData(), size_t(json.size()));
+        header->length = quint32(json.size());
+        header->magic = SHARED_MAGIC;
+    } else {
+        qWarning() << "shared state too large, not published";
+    }
+    memory_.unlock();
+}
+
+void HostCoordinator::publishAddress(bool isIpv4, const QString &address)
+{
+    if (!enabled_ || !isDiscoveryLeader()) {
+        return;
+    }
+
+    QJsonObject entry;
+    entry["address"] = address;
+    entry["time"] = QDateTime::currentMSecsSinceEpoch();
+    entry["pid"] = QCoreApplication::applicationPid();
+    updateShared([&](QJsonObject &state) {
+        state[isIpv4 ? "ipv4" : "ipv6"] = entry;
+    });
+}
+
+bool HostCoordinator::sharedAddress(bool isIpv4, qint64 maxAge, QString &address) const
+{
+    const QJsonObject entry = readShared()[isIpv4 ? "ipv4" : "ipv6"].toObject();
+    const qint64 age = QDateTime::currentMSecsSinceEpoch() - entry["time"].toInteger();
+    if (entry.isEmpty() || age > maxAge) {
+        return false;
+    }
+    address = entry["address"].toString();
+    return !address.isEmpty();
+}
+
+void HostCoordinator::publishResult(const QString &provider, const QString &records,
+                                    const StateCache::Published &published)
+{
+    if (!enabled_) {
+        return;
+    }
+
+    QJsonObject entry;
+    entry["ipv4"] = published.ipv4;
+    entry["ipv6"] = published.ipv6;
+    entry["records"] = QJsonArray::fromStringList(published.records);
+    entry["ttl"] = published.ttl;
+    entry["success"] = published.success;
+    entry["message"] = published.message;
+    entry["time"] = published.time.toString(Qt::ISODate);
+
+    const QString key = updateLockName(provider, records);
+    updateShared([&](QJsonObject &state) {
+        QJsonObject results = state["published"].toObject();
+        results[key] = entry;
+        state["published"] = results;
+    });
+}
+
+bool HostCoordinator::sharedResult(const QString &provider, const QString &records,
+                                   StateCache::Published &published) const
+{
+    const QJsonObject entry = readShared()["published"].toObject()[updateLockName(provider, records)].toObject();
+    if (entry.isEmpty()) {
+        return false;
+    }
+
+    published.ipv4 = entry["ipv4"].toString();
+    published.ipv6 = entry["ipv6"].toString();
+    published.records.clear();
+    for (const QJsonValue &record : entry["records"].toArray()) {
+        published.records.append(record.toString());
+    }
+    published.ttl = entry["ttl"].toInt(1);
+    published.success = entry["success"].toBool();
+    published.message = entry["message"].toString();
+    published.time = QDateTime::fromString(entry["time"].toString(), Qt::ISODate);
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef HOSTCOORDINATOR_H
+#define HOSTCOORDINATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QJsonObject>
+#include <QLockFile>
+#include <QSharedMemory>
+#include <QSharedPointer>
+#include <functional>
+
+#include "statecache.h"
+
+// 同一台机器上多个实例之间的协调
+//
+// 地址发现和每个（服务商, 记录）的写入各由一个锁文件选出主实例，
+// 主实例把结果写入共享内存，其他实例直接读取，不再各自发起网络请求。
+// 锁在进程退出后自动失效，其他实例在下一次尝试时接管。
+//
+// 协调只在同一用户的实例之间进行：共享内存只对创建者可读写，锁文件也放在用户自己的运行时目录，
+// 不同用户运行的实例互不可见，各自发现和写入。
+class HostCoordinator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HostCoordinator(QObject *parent = nullptr);
+    ~HostCoordinator() override;
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled_; }
+
+    // 尝试成为地址发现的主实例，已经是主实例时直接返回 true
+    bool acquireDiscovery();
+    bool isDiscoveryLeader() const { return isHeld(discoveryLockName()); }
+    // 尝试成为该服务商和记录的写入主实例
+    bool acquireUpdate(const QString &provider, const QString &records);
+    // 停止更新后放弃所有写入锁，由仍在运行的实例接管
+    void releaseUpdates();
+
+    // 主实例发布发现的地址
+    void publishAddress(bool isIpv4, const QString &address);
+    // 读取主实例发现的地址，超过 maxAge（毫秒）视为无效
+    bool sharedAddress(bool isIpv4, qint64 maxAge, QString &address) const;
+
+    // 主实例发布写入结果
+    void publishResult(const QString &provider, const QString &records, const StateCache::Published &published);
+    bool sharedResult(const QString &provider, const QString &records, StateCache::Published &published) const;
+
+private:
+    static QString discoveryLockName() { return "discovery"; }
+    static QString updateLockName(const QString &provider, const QString &records);
+
+    bool acquire(const QString &name);
+    bool isHeld(const QString &name) const;
+    void releaseAll();
+
+    bool attach() const;
+    // 调用前须已持有共享内存的锁
+    QJsonObject parseLocked() const;
+    QJsonObject readShared() const;
+    void updateShared(const std::function<void(QJsonObject &)> &update);
+
+private:
+    bool enabled_ = false;
+    QHash<QString, QSharedPointer<QLockFile>> locks_;
+    mutable QSharedMemory memory_;
+};
+
+#endif // HOSTCOORDINATOR_H
@@ -0,0 +1,78 @@
+#include "ipdiscovery.h"
+#include "timerwheel.h"
+
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrl>
+#include <QPair>
+#include <QList>
+#include <QDebug>
+
+void IpDiscovery::discover(int timeout)
+{
+    if (isRunning()) {
+        qDebug() << "ip discovery already running";
+        return;
+    }
+
+    qDebug() << "update ip address";
+
+    const QList<QPair<bool, QUrl>> endpoints = {
+        {true, QUrl("https://api.ipify.org?format=json")},
+        {false, QUrl("https://api6.ipify.org?format=json")},
+    };
+
+    pending_ = endpoints.size();
+    for (const auto &endpoint : endpoints) {
+        const bool isIpv4 = endpoint.first;
+        ManagedReply *reply = requestManager_->get(QNetworkRequest(endpoint.second));
+
+        TimerWheel::getInstance().schedule(timeout, reply, [reply]() {
+            if (reply->isRunning()) {
+                qWarning() << "ip discovery time out:" << reply->url().host();
+                reply->abort();
+            }
+        });
+
+        connect(reply, &ManagedReply::finished, this, [this, reply, isIpv4]() {
+            handleReply(reply, isIpv4);
+            if (--pending_ == 0) {
+                emit finished();
+            }
+        });
+    }
+}
+
+void IpDiscovery::handleReply(ManagedReply *reply, bool isIpv4)
+{
+    const QString family = isIpv4 ? "IPv4" : "IPv6";
+    if (reply->error() != QNetworkReply::NoError) {
+        emit failed(isIpv4, QString("Failed to get %1").arg(family));
+        return;
+    }
+
+    const QString address = parseReply(reply->readAll(), isIpv4);
+    if (address.isEmpty()) {
+        emit failed(isIpv4, QString("No public %1").arg(family));
+        return;
+    }
+
+    emit discovered(isIpv4, address);
+}
+
+QString IpDiscovery::parseReply(const QByteArray &data, bool isIpv4)
+{
+    // 请求的是 format=json，兼容纯文本响应
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    QString ip = doc.isObject() ? doc.object()["ip"].toString()
+                                : QString::fromUtf8(data).trimmed();
+
+    QHostAddress address(ip);
+    QAbstractSocket::NetworkLayerProtocol expected = isIpv4 ? QAbstractSocket::IPv4Protocol
+                                                            : QAbstractSocket::IPv6Protocol;
+    if (ip.isEmpty() || address.protocol() != expected) {
+        return QString();
+    }
+    return address.toString();
+}
@@ -0,0 +1,39 @@
+#ifndef IPDISCOVERY_H
+#define IPDISCOVERY_H
+
+#include <QObject>
+#include <QString>
+
+#include "requestmanager.h"
+
+// 通过 ipify 查询公网 IPv4/IPv6 地址
+class IpDiscovery : public QObject
+{
+    Q_OBJECT
+public:
+    IpDiscovery(RequestManager *requestManager, QObject *parent = nullptr)
+        : QObject(parent), requestManager_(requestManager) {};
+
+    virtual ~IpDiscovery() = default;
+
+    // 模拟模式下替换为按轨迹返回地址的实现
+    virtual void discover(int timeout = 30000);
+    bool isRunning() const { return pending_ > 0; }
+
+    // 解析 ipify 的响应（JSON 或纯文本），地址族不符或无效时返回空字符串
+    static QString parseReply(const QByteArray &data, bool isIpv4);
+
+signals:
+    void discovered(bool isIpv4, const QString &address);
+    void failed(bool isIpv4, const QString &reason);
+    void finished();
+
+private:
+    void handleReply(ManagedReply *reply, bool isIpv4);
+
+private:
+    RequestManager *requestManager_;
+    int pending_ = 0;
+};
+
+#endif // IPDISCOVERY_H
@@ -0,0 +1,436 @@
+#include "journal.h"
+
+#include <QStandardPaths>
+#include <QDir>
+#include <QDateTime>
+#include <QtEndian>
+#include <QDebug>
+
+#include <cstring>
+
+namespace {
+
+const char MAGIC[] = "DDNSJNL";
+const quint8 VERSION = 1;
+const int HEADER_SIZE = 8;
+// u32 长度 + u16 CRC
+const int FRAME_SIZE = 6;
+// 单条记录的上限，超过说明数据已损坏
+const quint32 MAX_RECORD = 64 * 1024;
+
+void putU8(QByteArray &out, quint8 value)
+{
+    out.append(char(value));
+}
+
+void putU16(QByteArray &out, quint16 value)
+{
+    char buffer[2];
+    qToLittleEndian(value, buffer);
+    out.append(buffer, 2);
+}
+
+void putU32(QByteArray &out, quint32 value)
+{
+    char buffer[4];
+    qToLittleEndian(value, buffer);
+    out.append(buffer, 4);
+}
+
+void putI64(QByteArray &out, qint64 value)
+{
+    char buffer[8];
+    qToLittleEndian(value, buffer);
+    out.append(buffer, 8);
+}
+
+void putString(QByteArray &out, const QString &value)
+{
+    const QByteArray utf8 = value.toUtf8().left(0xffff);
+    putU16(out, quint16(utf8.size()));
+    out.append(utf8);
+}
+
+// 按顺序读取记录内容，越界后 ok 为 false
+struct Cursor
+{
+    const uchar *pos;
+    const uchar *end;
+    bool ok = true;
+
+    bool need(qint64 size)
+    {
+        ok = ok && end - pos >= size;
+        return ok;
+    }
+    quint8 u8()
+    {
+        return need(1) ? *pos++ : 0;
+    }
+    quint16 u16()
+    {
+        if (!need(2)) {
+            return 0;
+        }
+        const quint16 value = qFromLittleEndian<quint16>(pos);
+        pos += 2;
+        return value;
+    }
+    quint32 u32()
+    {
+        if (!need(4)) {
+            return 0;
+        }
+        const quint32 value = qFromLittleEndian<quint32>(pos);
+        pos += 4;
+        return value;
+    }
+    qint64 i64()
+    {
+        if (!need(8)) {
+            return 0;
+        }
+        const qint64 value = qFromLittleEndian<qint64>(pos);
+        pos += 8;
+        return value;
+    }
+    QString string()
+    {
+        const quint16 size = u16();
+        if (!need(size)) {
+            return QString();
+        }
+        const QString value = QString::fromUtf8(reinterpret_cast<const char *>(pos), size);
+        pos += size;
+        return value;
+    }
+};
+
+// 逐条校验段内的记录，返回最后一条完整记录之后的偏移；段头无效时返回 -1
+qint64 scanSegment(const uchar *data, qint64 size, const std::function<void(const uchar *, quint32)> &callback)
+{
+    if (size < HEADER_SIZE || std::memcmp(data, MAGIC, HEADER_SIZE - 1) != 0 || data[HEADER_SIZE - 1] != VERSION) {
+        return -1;
+    }
+
+    qint64 pos = HEADER_SIZE;
+    while (pos + FRAME_SIZE <= size) {
+        const quint32 length = qFromLittleEndian<quint32>(data + pos);
+        const quint16 crc = qFromLittleEndian<quint16>(data + pos + 4);
+        if (length == 0 || length > MAX_RECORD || pos + FRAME_SIZE + length > size) {
+            break;
+        }
+        const uchar *body = data + pos + FRAME_SIZE;
+        if (qChecksum(QByteArrayView(body, length)) != crc) {
+            break;
+        }
+        if (callback) {
+            callback(body, length);
+        }
+        pos += FRAME_SIZE + length;
+    }
+    return pos;
+}
+
+}
+
+QString Journal::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/journal";
+}
+
+QString Journal::segmentName(int sequence)
+{
+    return QString("%1.jnl").arg(sequence, 8, 10, QChar('0'));
+}
+
+bool Journal::open(const QString &directory)
+{
+    close();
+    directory_ = directory.isEmpty() ? defaultDirectory() : directory;
+    QDir dir(directory_);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qWarning() << "Could not create journal directory" << directory_;
+        return false;
+    }
+
+    // 接着写最新的一段
+    const QStringList segments = dir.entryList(QStringList{"*.jnl"}, QDir::Files, QDir::Name);
+    if (segments.isEmpty()) {
+        return openSegment(1);
+    }
+    const int sequence = segments.last().section('.', 0, 0).toInt();
+    if (!openSegment(sequence)) {
+        return false;
+    }
+
+    // 截掉进程中断时写到一半的记录
+    const qint64 size = file_.size();
+    uchar *data = size > 0 ? file_.map(0, size) : nullptr;
+    const qint64 valid = data ? scanSegment(data, size, nullptr) : -1;
+    if (data) {
+        file_.unmap(data);
+    }
+    if (valid < 0) {
+        qWarning() << "journal segment" << file_.fileName() << "is damaged, starting a new one";
+        return openSegment(sequence + 1);
+    }
+    if (valid < size) {
+        qWarning() << "journal: dropping" << size - valid << "trailing bytes of an incomplete record";
+        file_.resize(valid);
+    }
+    return true;
+}
+
+void Journal::close()
+{
+    if (file_.isOpen()) {
+        file_.close();
+    }
+}
+
+bool Journal::openSegment(int sequence)
+{
+    close();
+    file_.setFileName(directory_ + "/" + segmentName(sequence));
+    // O_APPEND：同机多个实例写同一段时各条记录不会相互覆盖
+    if (!file_.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        qWarning() << "Could not open journal segment:" << file_.errorString();
+        return false;
+    }
+    sequence_ = sequence;
+
+    if (file_.size() == 0) {
+        file_.write(MAGIC, HEADER_SIZE - 1);
+        file_.write(reinterpret_cast<const char *>(&VERSION), 1);
+        file_.flush();
+    }
+    removeOldSegments();
+    return true;
+}
+
+void Journal::removeOldSegments()
+{
+    QDir dir(directory_);
+    const QStringList segments = dir.entryList(QStringList{"*.jnl"}, QDir::Files, QDir::Name);
+    for (int i = 0; i + maxSegments_ < segments.size(); ++i) {
+        dir.remove(segments.at(i));
+    }
+}
+
+void Journal::append(Type type, const QByteArray &payload)
+{
+    if (!file_.isOpen()) {
+        return;
+    }
+
+    QByteArray body;
+    body.reserve(9 + payload.size());
+    putU8(body, type);
+    putI64(body, QDateTime::currentMSecsSinceEpoch());
+    body.append(payload);
+
+    QByteArray frame;
+    frame.reserve(FRAME_SIZE + body.size());
+    putU32(frame, quint32(body.size()));
+    putU16(frame, qChecksum(body));
+    frame.append(body);
+
+    if (file_.size() > HEADER_SIZE && file_.size() + frame.size() > segmentSize_) {
+        if (!openSegment(sequence_ + 1)) {
+            return;
+        }
+    }
+    // 每条记录立即落盘，崩溃时最多丢失最后一条
+    file_.write(frame);
+    file_.flush();
+}
+
+void Journal::recordDiscovery(bool isIpv4, const QString &address)
+{
+    Seen &seen = seen_[isIpv4 ? 0 : 1];
+    if (seen.address == address) {
+        seen.time = QDateTime::currentMSecsSinceEpoch();
+    }
+
+    QByteArray payload;
+    putU8(payload, isIpv4 ? 4 : 6);
+    putString(payload, address);
+    append(Discovered, payload);
+}
+
+void Journal::recordChange(bool isIpv4, const QString &from, const QString &to)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    Seen &seen = seen_[isIpv4 ? 0 : 1];
+    // 本次运行中没有见过旧地址时延迟未知
+    const qint64 lag = (!from.isEmpty() && seen.address == from) ? now - seen.time : -1;
+    seen.address = to;
+    seen.time = now;
+
+    QByteArray payload;
+    putU8(payload, isIpv4 ? 4 : 6);
+    putString(payload, from);
+    putString(payload, to);
+    putI64(payload, lag);
+    append(Changed, payload);
+}
+
+void Journal::recordWrite(const QString &provider, const StateCache::Published &published, qint64 latency)
+{
+    QByteArray payload;
+    putString(payload, provider);
+    putU8(payload, published.success ? 1 : 0);
+    putU32(payload, quint32(qBound<qint64>(0, latency, 0xffffffff)));
+    putString(payload, published.ipv4);
+    putString(payload, published.ipv6);
+    putU32(payload, quint32(published.ttl));
+    putString(payload, published.message);
+    append(ProviderWrite, payload);
+}
+
+JournalReader::JournalReader(const QString &directory)
+    : directory_(directory)
+{
+}
+
+JournalReader::~JournalReader()
+{
+    close();
+}
+
+bool JournalReader::open()
+{
+    close();
+    QDir dir(directory_);
+    const QStringList names = dir.entryList(QStringList{"*.jnl"}, QDir::Files, QDir::Name);
+    for (const QString &name : names) {
+        Segment segment;
+        segment.file = new QFile(dir.filePath(name));
+        segment.size = segment.file->size();
+        if (segment.size < HEADER_SIZE || !segment.file->open(QIODevice::ReadOnly)) {
+            delete segment.file;
+            continue;
+        }
+        segment.data = segment.file->map(0, segment.size);
+        if (!segment.data) {
+            qWarning() << "Could not map journal segment" << name;
+            delete segment.file;
+            continue;
+        }
+
+        // 段内第一条记录的时间，用于跳过整段
+        const qint64 first = HEADER_SIZE + FRAME_SIZE;
+        if (segment.size >= first + 9) {
+            segment.firstTime = qFromLittleEndian<qint64>(segment.data + first + 1);
+        }
+        segments_.append(segment);
+    }
+    return !segments_.isEmpty();
+}
+
+void JournalReader::close()
+{
+    for (const Segment &segment : std::as_const(segments_)) {
+        delete segment.file;
+    }
+    segments_.clear();
+}
+
+void JournalReader::forEach(qint64 since, quint32 types, const std::function<void(const Entry &)> &callback) const
+{
+    for (int i = 0; i < segments_.size(); ++i) {
+        // 下一段开始时间不晚于 since 时，本段的记录都更早
+        if (i + 1 < segments_.size() && segments_.at(i + 1).firstTime > 0 && segments_.at(i + 1).firstTime <= since) {
+            continue;
+        }
+
+        const Segment &segment = segments_.at(i);
+        scanSegment(segment.data, segment.size, [&](const uchar *body, quint32 length) {
+            // 先看类型和时间，不需要的记录不解码
+            const Journal::Type type = Journal::Type(body[0]);
+            if (length < 9 || (types != 0 && !(types & mask(type)))) {
+                return;
+            }
+            Cursor cursor{body + 1, body + length};
+            Entry entry;
+            entry.type = type;
+            entry.time = cursor.i64();
+            if (entry.time < since) {
+                return;
+            }
+
+            switch (type) {
+            case Journal::Discovered:
+                entry.isIpv4 = cursor.u8() == 4;
+                entry.address = cursor.string();
+                break;
+            case Journal::Changed:
+                entry.isIpv4 = cursor.u8() == 4;
+                entry.previous = cursor.string();
+                entry.address = cursor.string();
+                entry.lag = cursor.i64();
+                break;
+            case Journal::ProviderWrite:
+                entry.provider = cursor.string();
+                entry.success = cursor.u8() != 0;
+                entry.latency = cursor.u32();
+                entry.ipv4 = cursor.string();
+                entry.ipv6 = cursor.string();
+                entry.ttl = int(cursor.u32());
+                entry.message = cursor.string();
+                break;
+            default:
+                // 新版本加入的类型
+                return;
+            }
+            if (cursor.ok) {
+                callback(entry);
+            }
+        });
+    }
+}
+
+QList<JournalReader::Entry> JournalReader::changesSince(qint64 since) const
+{
+    QList<Entry> changes;
+    forEach(since, mask(Journal::Changed), [&changes](const Entry &entry) {
+        changes.append(entry);
+    });
+    return changes;
+}
+
+double JournalReader::meanDetectionLag(qint64 since) const
+{
+    qint64 total = 0;
+    int count = 0;
+    forEach(since, mask(Journal::Changed), [&total, &count](const Entry &entry) {
+        if (entry.lag >= 0) {
+            total += entry.lag;
+            ++count;
+        }
+    });
+    return count > 0 ? double(total) / count : -1;
+}
+
+bool JournalReader::rebuild(StateCache &cache) const
+{
+    bool found = false;
+    forEach(0, mask(Journal::Changed) | mask(Journal::ProviderWrite), [&cache, &found](const Entry &entry) {
+        const QDateTime time = QDateTime::fromMSecsSinceEpoch(entry.time);
+        if (entry.type == Journal::Changed) {
+            cache.setAddress(entry.isIpv4, entry.address, time);
+        } else {
+            StateCache::Published published;
+            published.ipv4 = entry.ipv4;
+            published.ipv6 = entry.ipv6;
+            published.ttl = entry.ttl;
+            published.success = entry.success;
+            published.message = entry.message;
+            published.time = time;
+            cache.setPublished(entry.provider, published);
+        }
+        found = true;
+    });
+    return found;
+}
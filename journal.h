@@ -0,0 +1,116 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QFile>
+#include <functional>
+
+#include "statecache.h"
+
+// 只追加的二进制日志：地址发现、地址变化和服务商写入，用于事后排查和统计
+//
+// 日志按段存放在数据目录的 journal 子目录，每段以 8 字节的魔数和版本开头，之后是若干条记录：
+//   u32 长度 | u16 CRC | u8 类型 | i64 时间（Unix 毫秒） | 内容
+// 整数为小端，字符串为 u16 长度加 UTF-8。段超过大小上限后换新段，只保留最近的若干段。
+// 写到一半的记录在重新打开时截掉。
+class Journal
+{
+public:
+    enum Type : quint8 {
+        Discovered = 1,     // 一次地址发现或推送的结果
+        Changed = 2,        // 确认的地址变化
+        ProviderWrite = 3,  // 一个服务商一轮写入的结果
+    };
+
+    static QString defaultDirectory();
+
+    bool open(const QString &directory = QString());
+    void close();
+    bool isOpen() const { return file_.isOpen(); }
+    QString directory() const { return directory_; }
+
+    void setSegmentSize(qint64 bytes) { segmentSize_ = bytes; }
+    void setMaxSegments(int count) { maxSegments_ = count; }
+
+    void recordDiscovery(bool isIpv4, const QString &address);
+    // 检测延迟为旧地址最后一次被确认到新地址提交之间的时间，是实际延迟的上限
+    void recordChange(bool isIpv4, const QString &from, const QString &to);
+    void recordWrite(const QString &provider, const StateCache::Published &published, qint64 latency);
+
+private:
+    static QString segmentName(int sequence);
+    void append(Type type, const QByteArray &payload);
+    bool openSegment(int sequence);
+    void removeOldSegments();
+
+private:
+    struct Seen {
+        QString address;
+        qint64 time = 0;
+    };
+
+    QString directory_;
+    QFile file_;
+    int sequence_ = 0;
+    qint64 segmentSize_ = 1024 * 1024;
+    int maxSegments_ = 16;
+    // 各地址族当前地址最后一次被发现的时间
+    Seen seen_[2];
+};
+
+// 通过内存映射读取日志段，按时间查询
+class JournalReader
+{
+public:
+    struct Entry {
+        Journal::Type type = Journal::Discovered;
+        qint64 time = 0;
+        bool isIpv4 = true;
+        QString address;        // 发现的地址或变化后的地址
+        QString previous;       // 变化前的地址
+        qint64 lag = -1;        // 检测延迟，未知时为 -1
+
+        QString provider;
+        bool success = false;
+        qint64 latency = 0;
+        QString ipv4;
+        QString ipv6;
+        int ttl = 1;
+        QString message;
+    };
+
+    explicit JournalReader(const QString &directory = Journal::defaultDirectory());
+    ~JournalReader();
+    JournalReader(const JournalReader &) = delete;
+    JournalReader &operator=(const JournalReader &) = delete;
+
+    bool open();
+    void close();
+    int segmentCount() const { return segments_.size(); }
+
+    // 依次访问 since（Unix 毫秒）之后指定类型的记录；types 为类型位掩码，0 表示全部
+    void forEach(qint64 since, quint32 types, const std::function<void(const Entry &)> &callback) const;
+
+    QList<Entry> changesSince(qint64 since) const;
+    // 平均检测延迟（毫秒），没有可用数据时返回 -1
+    double meanDetectionLag(qint64 since) const;
+    // 按日志重放最后的地址和各服务商的写入结果
+    bool rebuild(StateCache &cache) const;
+
+    static quint32 mask(Journal::Type type) { return 1u << type; }
+
+private:
+    struct Segment {
+        QFile *file = nullptr;
+        const uchar *data = nullptr;
+        qint64 size = 0;
+        qint64 firstTime = 0;
+    };
+
+    QString directory_;
+    QList<Segment> segments_;
+};
+
+#endif // JOURNAL_H
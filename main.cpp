@@ -1,10 +1,134 @@
 #include "mainwindow.h"
+#include "oncerunner.h"
+#include "simulator.h"
+#include "mockapiserver.h"
+#include "journal.h"
+#include "soak.h"
+
 #include <QApplication>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QDateTime>
+#include <QElapsedTimer>
+
+// 列出最近的地址变化，并汇总检测延迟和写入耗时
+static int printJournal(int days)
+{
+    JournalReader reader;
+    if (!reader.open()) {
+        QTextStream(stderr) << "No journal found in " << Journal::defaultDirectory() << "\n";
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    const qint64 since = QDateTime::currentMSecsSinceEpoch() - qint64(qMax(days, 1)) * 24 * 3600 * 1000;
+    const QList<JournalReader::Entry> changes = reader.changesSince(since);
+    for (const JournalReader::Entry &entry : changes) {
+        out << QString("%1  %2  %3 -> %4\n")
+                   .arg(QDateTime::fromMSecsSinceEpoch(entry.time).toString(Qt::ISODate),
+                        QString(entry.isIpv4 ? "IPv4" : "IPv6"),
+                        entry.previous.isEmpty() ? "(none)" : entry.previous,
+                        entry.address);
+    }
+
+    int writes = 0;
+    int failed = 0;
+    qint64 latency = 0;
+    reader.forEach(since, JournalReader::mask(Journal::ProviderWrite), [&](const JournalReader::Entry &entry) {
+        ++writes;
+        failed += entry.success ? 0 : 1;
+        latency += entry.latency;
+    });
+
+    const double lag = reader.meanDetectionLag(since);
+    out << QString("%1 change(s), mean detection lag %2\n")
+               .arg(changes.size())
+               .arg(lag < 0 ? QString("n/a") : QString("%1 s").arg(lag / 1000, 0, 'f', 1));
+    out << QString("%1 provider write(s), %2 failed, mean latency %3 ms\n")
+               .arg(writes)
+               .arg(failed)
+               .arg(writes > 0 ? latency / writes : 0);
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
+    // 启动耗时从进程入口算起，包括解析参数和创建 QApplication
+    QElapsedTimer startup;
+    startup.start();
+
+    QStringList arguments;
+    for (int i = 0; i < argc; ++i) {
+        arguments.append(QString::fromLocal8Bit(argv[i]));
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Dynamic DNS updater");
+    QCommandLineOption helpOption = parser.addHelpOption();
+    QCommandLineOption onceOption("once", "Run a single discovery and update cycle, then exit.");
+    QCommandLineOption recordOption("record", "Only update the record named <name>.", "name");
+    QCommandLineOption deadlineOption("deadline", "Give up after <seconds> (default 30).", "seconds", "30");
+    QCommandLineOption forceOption("force", "Update even if the cached state says the record is current.");
+    QCommandLineOption simulateOption("simulate", "Replay the IP-change trace <file> on a virtual clock against the mock provider.", "file");
+    QCommandLineOption durationOption("duration", "Simulated time span, e.g. 7d (default: last event + 1d).", "time");
+    QCommandLineOption mockApiOption("mock-api", "Serve a local stand-in for the provider HTTP APIs on <port>.", "port");
+    QCommandLineOption journalOption("journal", "Summarize the journal of the last <days> days, then exit.", "days");
+    QCommandLineOption soakOption("soak", "Run <cycles> back-to-back update cycles against a local mock API and fail if memory, objects or sockets keep growing.", "cycles");
+    parser.addOptions({onceOption, recordOption, deadlineOption, forceOption, simulateOption, durationOption,
+                       mockApiOption, journalOption, soakOption});
+    parser.parse(arguments);
+
+    if (parser.isSet(helpOption)) {
+        QTextStream(stdout) << parser.helpText();
+        return 0;
+    }
+
+    // 单次模式不初始化图形界面，减少启动开销
+    if (parser.isSet(onceOption)) {
+        QCoreApplication a(argc, argv);
+        int deadline = parser.value(deadlineOption).toInt();
+        OnceRunner runner(parser.value(recordOption),
+                          (deadline > 0 ? deadline : 30) * 1000,
+                          parser.isSet(forceOption));
+        return runner.run();
+    }
+
+    if (parser.isSet(simulateOption)) {
+        QCoreApplication a(argc, argv);
+        qint64 duration = parser.isSet(durationOption) ? Simulator::parseDuration(parser.value(durationOption)) : 0;
+        if (duration < 0) {
+            QTextStream(stderr) << "Invalid --duration value\n";
+            return 1;
+        }
+        Simulator simulator(parser.value(simulateOption), duration);
+        return simulator.run();
+    }
+
+    if (parser.isSet(soakOption)) {
+        QCoreApplication a(argc, argv);
+        // 至少需要预热加若干个采样周期
+        Soak soak(qMax(20, parser.value(soakOption).toInt()));
+        return soak.run();
+    }
+
+    if (parser.isSet(journalOption)) {
+        QCoreApplication a(argc, argv);
+        return printJournal(parser.value(journalOption).toInt());
+    }
+
+    // 服务商接口的本地替身，配置 endpoint 指向它后可离线联调
+    if (parser.isSet(mockApiOption)) {
+        QCoreApplication a(argc, argv);
+        MockApiServer server;
+        if (!server.listen(quint16(parser.value(mockApiOption).toUInt()))) {
+            return 1;
+        }
+        return a.exec();
+    }
+
     QApplication a(argc, argv);
-    MainWindow w;
+    MainWindow w(startup);
     w.show();
     return a.exec();
 }
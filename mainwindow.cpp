@@ -22,13 +22,22 @@
 #include <QRegExp>
 #include <QJsonArray>
 #include <QNetworkInterface>
+#include <QTimer>
+#include <QEvent>
+
+static const QStringList PROVIDER_NAMES = {"Cloudflare", "Aliyun", "DNSPod", "DuckDNS"};
+// 从进程启动到首帧绘制的目标时长
+static const int STARTUP_BUDGET_MS = 100;
 
 MainWindow::~MainWindow() {}
 
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(const QElapsedTimer &startup, QWidget *parent)
     : QMainWindow(parent)
+    , startupTimer(startup)
     , networkManager(new QNetworkAccessManager(this))
+    , service(new DdnsService(networkManager, this))
 {
+
     setWindowTitle("DDNS Configuration");
     setMinimumSize(400, 300);
 
@@ -47,7 +56,7 @@ MainWindow::MainWindow(QWidget *parent)
     QHBoxLayout *providerLayout = new QHBoxLayout();
     QLabel *providerLabel = new QLabel("DDNS Provider:", this);
     providerCombo = new QComboBox(this);
-    providerCombo->addItems({"Cloudflare", "Aliyun", "DNSPod", "DuckDNS"});
+    providerCombo->addItems(PROVIDER_NAMES);
     connect(providerCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::onProviderChanged);
 
@@ -78,27 +87,116 @@ MainWindow::MainWindow(QWidget *parent)
     // 创建堆叠窗口
     stackedWidget = new QStackedWidget(this);
 
-    // 创建各个提供商的配置界面
-    createCloudFlarePage();
-    createAliyunPage();
-    createDNSPodPage();
-    createDuckDNSPage();
+    // 先放占位页，各服务商的配置界面在选中时再创建
+    for (int i = 0; i < PROVIDER_NAMES.size(); ++i) {
+        stackedWidget->addWidget(new QWidget);
+    }
 
     // 添加所有部件到主布局
     mainLayout->addLayout(providerLayout);
     mainLayout->addWidget(stackedWidget);
+    setupTargetProviders(mainLayout);
     mainLayout->addStretch();
 
+    connect(service->dispatcher(), &UpdateDispatcher::providerFinished, this, &MainWindow::onProviderUpdateFinished);
+    connect(service->dispatcher(), &UpdateDispatcher::cycleFinished, this, &MainWindow::onUpdateCycleFinished);
+    connect(service, &DdnsService::addressDiscovered, this, &MainWindow::onAddressDiscovered);
+    connect(service, &DdnsService::discoveryFailed, this, &MainWindow::onDiscoveryFailed);
+    connect(service, &DdnsService::stateChanged, this, &MainWindow::onDampingStateChanged);
+    connect(service, &DdnsService::updateQueued, this, &MainWindow::onUpdateQueued);
+    connect(service, &DdnsService::updateDeferred, this, [this](const QStringList &providers) {
+        statusLabel->setText(QString("Waiting for another instance to update %1").arg(providers.join(", ")));
+    });
+    connect(service, &DdnsService::updateSkipped, this, [this](const QString &reason) {
+        QMessageBox::warning(this, "DDNS Error", reason);
+    });
+    connect(service, &DdnsService::configError, this, [this](const QString &message) {
+        QMessageBox::warning(this, "Configuration Error", message);
+    });
+
+    // 只跟随用户的勾选，探测失败导致的取消勾选不影响已确认地址的补发
+    connect(ipv4CheckBox, &QCheckBox::clicked, this, [this](bool checked) {
+        service->setFamilyEnabled(true, checked);
+    });
+    connect(ipv6CheckBox, &QCheckBox::clicked, this, [this](bool checked) {
+        service->setFamilyEnabled(false, checked);
+    });
+
     Config::getInstance().init();
     loadConfig();
+    ensureProviderPage(providerCombo->currentIndex());
+    stackedWidget->setCurrentIndex(providerCombo->currentIndex());
+    service->reloadConfig();
+    showCachedState();
 
-    // 初始更新IP地址
-    updateIPAddresses();
+    // 首帧绘制后再启动网络相关的任务
+    centralWidget->installEventFilter(this);
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (!firstFrameShown && watched == centralWidget() && event->type() == QEvent::Paint) {
+        firstFrameShown = true;
+        centralWidget()->removeEventFilter(this);
+
+        const qint64 elapsed = startupTimer.elapsed();
+        qInfo() << QString("first frame after %1 ms").arg(elapsed);
+        if (elapsed > STARTUP_BUDGET_MS) {
+            qWarning() << QString("startup exceeded %1 ms budget").arg(STARTUP_BUDGET_MS);
+        }
+        QTimer::singleShot(0, this, &MainWindow::startDeferred);
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::startDeferred()
+{
+    // 日志扫描和状态重建不占用首帧之前的时间
+    if (service->openJournal()) {
+        showCachedState();
+    }
+    service->startPushServer();
+
+    // 初始更新IP地址，之后每5分钟更新一次
+    service->startPolling(300000);
+}
+
+void MainWindow::showCachedState()
+{
+    // 上次确认的地址，在探测结果返回前先显示
+    const StateCache &cache = service->stateCache();
+    for (bool isIpv4 : {true, false}) {
+        const QString address = cache.address(isIpv4);
+        if (!address.isEmpty()) {
+            QLabel *label = isIpv4 ? ipv4Label : ipv6Label;
+            label->setText(QString("%1 (cached %2)")
+                               .arg(address, cache.addressTime(isIpv4).toString("yyyy-MM-dd hh:mm")));
+        }
+    }
+
+    // 各服务商最后一次写入的结果
+    QStringList lines;
+    QDateTime lastUpdate;
+    for (const QString &name : service->targetProviders()) {
+        const StateCache::Published published = cache.published(name);
+        if (!published.time.isValid()) {
+            continue;
+        }
+        lines.append(QString("%1: %2 %3")
+                         .arg(name)
+                         .arg(published.success ? "OK" : "FAILED")
+                         .arg(published.message));
+        if (!lastUpdate.isValid() || published.time > lastUpdate) {
+            lastUpdate = published.time;
+        }
+    }
+    if (!lines.isEmpty()) {
+        statusLabel->setText(QString("Last update %1\n%2")
+                                 .arg(lastUpdate.toString("yyyy-MM-dd hh:mm:ss"))
+                                 .arg(lines.join("\n")));
+    }
 
-    // 设置定时器每5分钟更新一次IP地址
-    ipUpdateTimer = new QTimer(this);
-    connect(ipUpdateTimer, &QTimer::timeout, this, &MainWindow::updateIPAddresses);
-    ipUpdateTimer->start(300000); // 5分钟 = 300000毫秒
+    onDampingStateChanged();
 }
 
 void MainWindow::loadConfig()
@@ -113,38 +211,34 @@ void MainWindow::loadConfig()
         providerCombo->setCurrentIndex(index);
     }
 
-    QJsonObject provider;
-    if( !Config::getInstance().getProvider(provider, lastProvider)) {
-        QMessageBox::information(this, "DDNS Service", "get config provider error.");
-    }
-
-    if(lastProvider == "Cloudflare") {
-        QJsonObject cf = provider["Cloudflare"].toObject();
-        cfApiKey->setText(cf["api_key"].toString());
-        cfZoneId->setText(cf["zone_id"].toString());
-        cfDomain->setText(cf["domain"].toString());
-    }
-
-    // Aliyun
-    if (provider.contains("Aliyun")) {
-        QJsonObject aliyun = provider["Aliyun"].toObject();
-        aliyunAccessKey->setText(aliyun["access_key"].toString());
-        aliyunSecretKey->setText(aliyun["secret_key"].toString());
-        aliyunDomain->setText(aliyun["domain"].toString());
+    // 加载需要同时更新的服务商
+    const QStringList targets = Config::getInstance().getTargetProviders();
+    for (auto it = targetCheckBoxes.begin(); it != targetCheckBoxes.end(); ++it) {
+        it.value()->setChecked(targets.contains(it.key()));
     }
+}
 
-    // DNSPod
-    if (provider.contains("DNSPod")) {
-        QJsonObject dnspod = provider["DNSPod"].toObject();
-        dnspodToken->setText(dnspod["token"].toString());
-        dnspodDomain->setText(dnspod["domain"].toString());
+void MainWindow::loadProviderConfig(const QString &provider)
+{
+    const QJsonObject config = Config::getInstance().getConfig()["providers"].toObject()[provider].toObject();
+    if (config.isEmpty()) {
+        return;
     }
 
-    // DuckDNS
-    if (provider.contains("DuckDNS")) {
-        QJsonObject duckdns = provider["DuckDNS"].toObject();
-        duckdnsToken->setText(duckdns["token"].toString());
-        duckdnsDomain->setText(duckdns["domain"].toString());
+    if (provider == "Cloudflare") {
+        cfApiKey->setText(config["api_key"].toString());
+        cfZoneId->setText(config["zone_id"].toString());
+        cfDomain->setText(config["domain"].toString());
+    } else if (provider == "Aliyun") {
+        aliyunAccessKey->setText(config["access_key"].toString());
+        aliyunSecretKey->setText(config["secret_key"].toString());
+        aliyunDomain->setText(config["domain"].toString());
+    } else if (provider == "DNSPod") {
+        dnspodToken->setText(config["token"].toString());
+        dnspodDomain->setText(config["domain"].toString());
+    } else if (provider == "DuckDNS") {
+        duckdnsToken->setText(config["token"].toString());
+        duckdnsDomain->setText(config["domain"].toString());
     }
 }
 
@@ -167,9 +261,6 @@ void MainWindow::setupControlGroup(QVBoxLayout *mainLayout)
     // 创建DDNS按钮
     ddnsButton = new QPushButton("Start DDNS", this);
     connect(ddnsButton, &QPushButton::clicked, this, &MainWindow::toggleDDNS);
-    // 创建DDNS更新定时器
-    ddnsTimer = new QTimer(this);
-    connect(ddnsTimer, &QTimer::timeout, this, &MainWindow::updateDNS);
 
     // 创建保存按钮
     QPushButton *saveButton = new QPushButton("Save Configuration", this);
@@ -188,6 +279,29 @@ void MainWindow::setupControlGroup(QVBoxLayout *mainLayout)
     mainLayout->addWidget(controlGroup);
 }
 
+void MainWindow::setupTargetProviders(QVBoxLayout *mainLayout)
+{
+    QGroupBox *targetGroup = new QGroupBox("Update Targets", this);
+    QVBoxLayout *targetLayout = new QVBoxLayout(targetGroup);
+
+    // 同一记录可同时发布到多个服务商
+    QHBoxLayout *checkLayout = new QHBoxLayout();
+    for (const QString &name : PROVIDER_NAMES) {
+        QCheckBox *checkBox = new QCheckBox(name, this);
+        targetCheckBoxes.insert(name, checkBox);
+        checkLayout->addWidget(checkBox);
+    }
+    checkLayout->addStretch();
+
+    statusLabel = new QLabel("No update yet", this);
+    statusLabel->setWordWrap(true);
+
+    targetLayout->addLayout(checkLayout);
+    targetLayout->addWidget(statusLabel);
+
+    mainLayout->addWidget(targetGroup);
+}
+
 void MainWindow::setupIPAddressDisplay(QVBoxLayout *mainLayout)
 {
     QGroupBox *ipGroup = new QGroupBox("Current IP Addresses", this);
@@ -215,83 +329,73 @@ void MainWindow::setupIPAddressDisplay(QVBoxLayout *mainLayout)
     ipv6Layout->addWidget(ipv6CheckBox);
     ipv6Layout->addStretch();
 
+    // 抖动抑制状态
+    dampingLabel = new QLabel(this);
+    dampingLabel->setWordWrap(true);
+
     ipLayout->addLayout(ipv4Layout);
     ipLayout->addLayout(ipv6Layout);
+    ipLayout->addWidget(dampingLabel);
 
     mainLayout->addWidget(ipGroup);
 }
 
 void MainWindow::updateIPAddresses()
 {
-    qDebug() << "update ip address";
-
     ipv4Label->setText("...");
     ipv6Label->setText("...");
 
-    // 获取IPv4地址
-    QNetworkRequest requestv4(QUrl("https://api.ipify.org?format=json"));
-    QNetworkReply *replyv4 = networkManager->get(requestv4);
-    connect(replyv4, &QNetworkReply::finished, [this, replyv4]() {
-        handleIPv4Reply(replyv4);
-    });
-
-    // 获取IPv6地址
-    QNetworkRequest requestv6(QUrl("https://api6.ipify.org?format=json"));
-    QNetworkReply *replyv6 = networkManager->get(requestv6);
-    connect(replyv6, &QNetworkReply::finished, [this, replyv6]() {
-        handleIPv6Reply(replyv6);
-    });
+    service->refreshAddresses();
 }
 
-void MainWindow::handleIPv4Reply(QNetworkReply *reply)
+void MainWindow::onAddressDiscovered(bool isIpv4, const QString &address)
 {
-    if (reply->error() == QNetworkReply::NoError) {
-        QString ipv4 = QString::fromUtf8(reply->readAll()).trimmed();
-        QHostAddress address(ipv4);
-        if (!ipv4.isEmpty() && address.protocol() == QAbstractSocket::IPv4Protocol) {
-            ipv4Label->setText(ipv4);
-            ipv4CheckBox->setEnabled(true);
-            ipv4CheckBox->setChecked(true);
-        } else {
-            ipv4Label->setText("No public IPv4");
-            ipv4CheckBox->setEnabled(false);
-            ipv4CheckBox->setChecked(false);
-        }
-    } else {
-        ipv4Label->setText("Failed to get IPv4");
-        ipv4CheckBox->setEnabled(false);
-        ipv4CheckBox->setChecked(false);
+    QLabel *label = isIpv4 ? ipv4Label : ipv6Label;
+    QCheckBox *checkBox = isIpv4 ? ipv4CheckBox : ipv6CheckBox;
+
+    label->setText(address);
+    // 重新变为可用时默认勾选
+    if (!checkBox->isEnabled()) {
+        checkBox->setEnabled(true);
+        checkBox->setChecked(true);
+        service->setFamilyEnabled(isIpv4, true);
     }
-    reply->deleteLater();
 }
 
-void MainWindow::handleIPv6Reply(QNetworkReply *reply)
+void MainWindow::onDiscoveryFailed(bool isIpv4, const QString &reason)
 {
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray data = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(data);
-        if (!doc.isNull()) {
-            QJsonObject obj = doc.object();
-            QString ip = obj["ip"].toString();
-            ipv6Label->setText(ip);
-            ipv6CheckBox->setEnabled(true);
-            ipv6CheckBox->setChecked(true);
-        } else {
-            ipv6Label->setText("No public IPv6");
-            ipv6CheckBox->setEnabled(false);
-            ipv6CheckBox->setChecked(false);
-        }
-    } else {
-        ipv6Label->setText("Failed to get IPv6");
-        ipv6CheckBox->setEnabled(false);
-        ipv6CheckBox->setChecked(false);
-    }
-    reply->deleteLater();
+    QLabel *label = isIpv4 ? ipv4Label : ipv6Label;
+    QCheckBox *checkBox = isIpv4 ? ipv4CheckBox : ipv6CheckBox;
+
+    label->setText(reason);
+    checkBox->setEnabled(false);
+    checkBox->setChecked(false);
+}
+
+void MainWindow::onDampingStateChanged()
+{
+    const FlapDamper *damper = service->damper();
+    const TtlPolicy &ttlPolicy = service->ttlPolicy();
+
+    int ttl = ttlPolicy.recordTtl();
+    dampingLabel->setText(QString("IPv4 %1\nIPv6 %2\nTTL: %3%4, verify every %5 s")
+                              .arg(damper->describe(true))
+                              .arg(damper->describe(false))
+                              .arg(ttl == 1 ? QString("auto") : QString("%1 s").arg(ttl))
+                              .arg(ttlPolicy.isUnstable() ? " (lowered while unstable)" : "")
+                              .arg(ttlPolicy.verifyInterval() / 1000));
+}
+
+void MainWindow::onUpdateQueued(int providers, const QDateTime &offlineSince)
+{
+    statusLabel->setText(QString("Offline since %1, %2 provider(s) queued")
+                             .arg(offlineSince.toString("hh:mm:ss"))
+                             .arg(providers));
 }
 
 void MainWindow::toggleDDNS()
 {
-    if (!ddnsRunning) {
+    if (!service->isRunning()) {
         // 检查是否有选中的IP地址
         if (!ipv4CheckBox->isChecked() && !ipv6CheckBox->isChecked()) {
             QMessageBox::warning(this, "DDNS Error",
@@ -299,13 +403,21 @@ void MainWindow::toggleDDNS()
             return;
         }
 
+        if (selectedProviders().isEmpty()) {
+            QMessageBox::warning(this, "DDNS Error",
+                                 "Please select at least one provider to update.");
+            return;
+        }
+
         saveConfig();
+        service->reloadConfig();
+        service->setFamilyEnabled(true, ipv4CheckBox->isChecked());
+        service->setFamilyEnabled(false, ipv6CheckBox->isChecked());
 
         // 开始DDNS服务
-        ddnsRunning = true;
         ddnsButton->setText("Stop DDNS");
-        updateDNS(); // 立即执行一次更新
-        ddnsTimer->start(300000); // 每5分钟更新一次
+        statusLabel->setText("Updating...");
+        service->start();
         QMessageBox::information(this, "DDNS Service",
                                  "DDNS service started for " +
                                      QString(ipv4CheckBox->isChecked() ? "IPv4" : "") +
@@ -313,127 +425,58 @@ void MainWindow::toggleDDNS()
                                      QString(ipv6CheckBox->isChecked() ? "IPv6" : ""));
     } else {
         // 停止DDNS服务
-        ddnsRunning = false;
         ddnsButton->setText("Start DDNS");
-        ddnsTimer->stop();
+        service->stop();
         QMessageBox::information(this, "DDNS Service", "DDNS service stopped");
     }
 }
 
-void MainWindow::updateDNS()
+QStringList MainWindow::selectedProviders() const
 {
-    // 检查是否有选中的IP地址
-    bool hasIpv4 = ipv4CheckBox->isEnabled() && ipv4CheckBox->isChecked();
-    bool hasIpv6 = ipv6CheckBox->isEnabled() && ipv6CheckBox->isChecked();
-
-    if (!hasIpv4 && !hasIpv6) {
-        QMessageBox::warning(this, "DDNS Error",
-                             "No public IP address selected for DDNS update. Please check your network connection and IP selection.");
-        return;
-    }
-
-    QString ipv4 = hasIpv4 ? ipv4Label->text() : QString();
-    QString ipv6 = hasIpv6 ? ipv6Label->text() : QString();
-
-    // 确保选中的IP地址是有效的
-    if (hasIpv4 && (ipv4 == "Checking..." || ipv4 == "Failed to get IPv4" || ipv4 == "No public IPv4")) {
-        QMessageBox::warning(this, "DDNS Error", "Invalid IPv4 address");
-        return;
-    }
-
-    if (hasIpv6 && (ipv6 == "Checking..." || ipv6 == "Failed to get IPv6" || ipv6 == "No public IPv6")) {
-        QMessageBox::warning(this, "DDNS Error", "Invalid IPv6 address");
-        return;
-    }
-
-    // 执行DDNS更新
-    QString provider = providerCombo->currentText();
-    if (provider == "Cloudflare") {
-        cloudflare_ = std::make_shared<Cloudflare>(networkManager);
-        cloudflare_->updateDnsRecord(cfApiKey, cfZoneId, cfDomain, ipv4, ipv6, ipv4RecordName, ipv6RecordName);
-    } else if (provider == "Aliyun") {
-        updateAliyun(ipv4, ipv6);
-    } else if (provider == "DNSPod") {
-        updateDNSPod(ipv4, ipv6);
-    } else if (provider == "DuckDNS") {
-        updateDuckDNS(ipv4, ipv6);
+    QStringList targets;
+    for (const QString &name : PROVIDER_NAMES) {
+        if (targetCheckBoxes.value(name)->isChecked()) {
+            targets.append(name);
+        }
     }
+    return targets;
 }
 
-void MainWindow::updateAliyun(const QString &ipv4, const QString &ipv6)
+void MainWindow::onProviderUpdateFinished(const ProviderStatus &status)
 {
-    // 获取配置
-    QString accessKey = aliyunAccessKey->text();
-    QString secretKey = aliyunSecretKey->text();
-    QString domain = aliyunDomain->text();
+    Q_UNUSED(status);
 
-    if (accessKey.isEmpty() || secretKey.isEmpty() || domain.isEmpty()) {
-        QMessageBox::warning(this, "Configuration Error", "Please fill in all Aliyun settings");
-        return;
+    QStringList lines;
+    for (const ProviderStatus &s : service->dispatcher()->statuses()) {
+        lines.append(QString("%1: %2").arg(s.provider, s.finished ? s.message : "updating..."));
     }
-
-    // 构建阿里云API请求
-    // 这里需要实现阿里云的API调用逻辑
-    // 参考：https://help.aliyun.com/document_detail/29776.html
+    statusLabel->setText(lines.join("\n"));
 }
 
-void MainWindow::updateDNSPod(const QString &ipv4, const QString &ipv6)
+void MainWindow::onUpdateCycleFinished(bool success, const QList<ProviderStatus> &statuses)
 {
-    // 获取配置
-    QString token = dnspodToken->text();
-    QString domain = dnspodDomain->text();
-
-    if (token.isEmpty() || domain.isEmpty()) {
-        QMessageBox::warning(this, "Configuration Error", "Please fill in all DNSPod settings");
-        return;
+    onDampingStateChanged();
+
+    QStringList lines;
+    for (const ProviderStatus &s : statuses) {
+        lines.append(QString("%1: %2 (%3 ms) %4")
+                         .arg(s.provider)
+                         .arg(s.success ? "OK" : "FAILED")
+                         .arg(s.elapsedMs)
+                         .arg(s.message));
     }
 
-    // 构建DNSPod API请求
-    // 这里需要实现DNSPod的API调用逻辑
-    // 参考：https://docs.dnspod.cn/api/
-}
+    statusLabel->setText(QString("Last update %1\n%2")
+                             .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss"))
+                             .arg(lines.join("\n")));
 
-void MainWindow::updateDuckDNS(const QString &ipv4, const QString &ipv6)
-{
-    // 获取配置
-    QString token = duckdnsToken->text();
-    QString domain = duckdnsDomain->text();
-
-    if (token.isEmpty() || domain.isEmpty()) {
-        QMessageBox::warning(this, "Configuration Error", "Please fill in all DuckDNS settings");
-        return;
+    // 汇总后只提示一次；断网导致的失败等联网后自动重试，不打扰用户
+    if (!success && service->reachability()->isOnline()) {
+        QMessageBox::warning(this, "DDNS Update Error", lines.join("\n"));
     }
-
-    // 构建DuckDNS API请求
-    QString subdomain = domain.split(".").first();
-    QUrl url(QString("https://www.duckdns.org/update?domains=%1&token=%2&ip=%3&ipv6=%4")
-                 .arg(subdomain)
-                 .arg(token)
-                 .arg(ipv4)
-                 .arg(ipv6));
-
-    QNetworkRequest request(url);
-    QNetworkReply *reply = networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, [this, reply]() {
-        handleDDNSReply(reply);
-    });
 }
 
-void MainWindow::handleDDNSReply(QNetworkReply *reply)
-{
-    if (reply->error() == QNetworkReply::NoError) {
-        QString response = reply->readAll();
-        qDebug() << "DDNS update response:" << response;
-        // 可以在这里添加更详细的响应处理逻辑
-    } else {
-        qDebug() << "DDNS update error:" << reply->errorString();
-        QMessageBox::warning(this, "DDNS Update Error",
-                             "Failed to update DNS records: " + reply->errorString());
-    }
-    reply->deleteLater();
-}
-
-void MainWindow::createCloudFlarePage()
+QWidget *MainWindow::createCloudFlarePage()
 {
     QWidget *page = new QWidget;
     QFormLayout *layout = new QFormLayout(page);
@@ -446,10 +489,10 @@ void MainWindow::createCloudFlarePage()
     layout->addRow("Zone ID:", cfZoneId);
     layout->addRow("Domain:", cfDomain);
 
-    stackedWidget->addWidget(page);
+    return page;
 }
 
-void MainWindow::createAliyunPage()
+QWidget *MainWindow::createAliyunPage()
 {
     QWidget *page = new QWidget;
     QFormLayout *layout = new QFormLayout(page);
@@ -462,10 +505,10 @@ void MainWindow::createAliyunPage()
     layout->addRow("Secret Key:", aliyunSecretKey);
     layout->addRow("Domain:", aliyunDomain);
 
-    stackedWidget->addWidget(page);
+    return page;
 }
 
-void MainWindow::createDNSPodPage()
+QWidget *MainWindow::createDNSPodPage()
 {
     QWidget *page = new QWidget;
     QFormLayout *layout = new QFormLayout(page);
@@ -476,10 +519,10 @@ void MainWindow::createDNSPodPage()
     layout->addRow("API Token:", dnspodToken);
     layout->addRow("Domain:", dnspodDomain);
 
-    stackedWidget->addWidget(page);
+    return page;
 }
 
-void MainWindow::createDuckDNSPage()
+QWidget *MainWindow::createDuckDNSPage()
 {
     QWidget *page = new QWidget;
     QFormLayout *layout = new QFormLayout(page);
@@ -490,17 +533,72 @@ void MainWindow::createDuckDNSPage()
     layout->addRow("Token:", duckdnsToken);
     layout->addRow("Domain:", duckdnsDomain);
 
-    stackedWidget->addWidget(page);
+    return page;
+}
+
+void MainWindow::ensureProviderPage(int index)
+{
+    if (index < 0 || index >= PROVIDER_NAMES.size() || builtPages.contains(PROVIDER_NAMES.at(index))) {
+        return;
+    }
+
+    const QString name = PROVIDER_NAMES.at(index);
+    QWidget *page = nullptr;
+    if (name == "Cloudflare") {
+        page = createCloudFlarePage();
+    } else if (name == "Aliyun") {
+        page = createAliyunPage();
+    } else if (name == "DNSPod") {
+        page = createDNSPodPage();
+    } else {
+        page = createDuckDNSPage();
+    }
+
+    // 用真正的页面替换占位页
+    QWidget *placeholder = stackedWidget->widget(index);
+    stackedWidget->insertWidget(index, page);
+    stackedWidget->removeWidget(placeholder);
+    placeholder->deleteLater();
+
+    builtPages.insert(name);
+    loadProviderConfig(name);
 }
 
 void MainWindow::onProviderChanged(int index)
 {
+    ensureProviderPage(index);
     stackedWidget->setCurrentIndex(index);
 }
 
+QJsonObject MainWindow::providerConfig(const QString &provider) const
+{
+    // 以已保存的配置为基础，界面上的字段覆盖对应项；未打开过的页面沿用已保存的配置
+    QJsonObject config = Config::getInstance().getConfig()["providers"].toObject()[provider].toObject();
+    if (!builtPages.contains(provider)) {
+        return config;
+    }
+    if (provider == "Cloudflare") {
+        config["api_key"] = cfApiKey->text();
+        config["zone_id"] = cfZoneId->text();
+        config["domain"] = cfDomain->text();
+    } else if (provider == "Aliyun") {
+        config["access_key"] = aliyunAccessKey->text();
+        config["secret_key"] = aliyunSecretKey->text();
+        config["domain"] = aliyunDomain->text();
+    } else if (provider == "DNSPod") {
+        config["token"] = dnspodToken->text();
+        config["domain"] = dnspodDomain->text();
+    } else if (provider == "DuckDNS") {
+        config["token"] = duckdnsToken->text();
+        config["domain"] = duckdnsDomain->text();
+    }
+    return config;
+}
+
 void MainWindow::saveConfig()
 {
-    QJsonObject config;
+    // 保留界面上没有的配置项
+    QJsonObject config = Config::getInstance().getConfig();
     QJsonObject providers;
 
     // 保存当前选择的提供商
@@ -509,31 +607,11 @@ void MainWindow::saveConfig()
     config["ipv4_record"] = ipv4RecordName->text();
     config["ipv6_record"] = ipv6RecordName->text();
 
-    // Cloudflare配置
-    QJsonObject cloudflare;
-    cloudflare["api_key"] = cfApiKey->text();
-    cloudflare["zone_id"] = cfZoneId->text();
-    cloudflare["domain"] = cfDomain->text();
-    providers["Cloudflare"] = cloudflare;
-
-    // Aliyun配置
-    QJsonObject aliyun;
-    aliyun["access_key"] = aliyunAccessKey->text();
-    aliyun["secret_key"] = aliyunSecretKey->text();
-    aliyun["domain"] = aliyunDomain->text();
-    providers["Aliyun"] = aliyun;
-
-    // DNSPod配置
-    QJsonObject dnspod;
-    dnspod["token"] = dnspodToken->text();
-    dnspod["domain"] = dnspodDomain->text();
-    providers["DNSPod"] = dnspod;
-
-    // DuckDNS配置
-    QJsonObject duckdns;
-    duckdns["token"] = duckdnsToken->text();
-    duckdns["domain"] = duckdnsDomain->text();
-    providers["DuckDNS"] = duckdns;
+    config[KEY_TARGET_PROVIDERS] = QJsonArray::fromStringList(selectedProviders());
+
+    for (const QString &name : PROVIDER_NAMES) {
+        providers[name] = providerConfig(name);
+    }
 
     config["providers"] = providers;
 
@@ -14,8 +14,12 @@
 #include <QCheckBox>
 #include <QHostAddress>
 #include <QVBoxLayout>
+#include <QMap>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QSet>
 
-#include "cloudflare.h"
+#include "ddnsservice.h"
 #include "networkwidget.h"
 
 class MainWindow : public QMainWindow
@@ -23,42 +27,53 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    // startup 为进程启动时开始计时的时钟，用于统计首帧耗时
+    explicit MainWindow(const QElapsedTimer &startup, QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private slots:
     void onProviderChanged(int index);
     void saveConfig();
     void updateIPAddresses();
-    void handleIPv4Reply(QNetworkReply *reply);
-    void handleIPv6Reply(QNetworkReply *reply);
+    void onAddressDiscovered(bool isIpv4, const QString &address);
+    void onDiscoveryFailed(bool isIpv4, const QString &reason);
     void toggleDDNS();
-    void updateDNS();
-    void handleDDNSReply(QNetworkReply *reply);
+    void onProviderUpdateFinished(const ProviderStatus &status);
+    void onUpdateCycleFinished(bool success, const QList<ProviderStatus> &statuses);
+    void onDampingStateChanged();
+    void onUpdateQueued(int providers, const QDateTime &offlineSince);
 
 private:
-    void createCloudFlarePage();
-    void createAliyunPage();
-    void createDNSPodPage();
-    void createDuckDNSPage();
+    // 服务商页面在第一次被选中时才创建
+    void ensureProviderPage(int index);
+    QWidget *createCloudFlarePage();
+    QWidget *createAliyunPage();
+    QWidget *createDNSPodPage();
+    QWidget *createDuckDNSPage();
+
+    // 启动时先显示上次保存的状态，首帧之后再开始网络请求
+    void showCachedState();
+    void startDeferred();
 
     void onRefreshClicked();
     void setupControlGroup(QVBoxLayout *mainLayout);
     void setupIPAddressDisplay(QVBoxLayout *mainLayout);
+    void setupTargetProviders(QVBoxLayout *mainLayout);
 
     void loadConfig();
     void loadProviderConfig(const QString &provider);
     QString getConfigFilePath();
-
-    void updateAliyun(const QString &ipv4, const QString &ipv6);
-    void updateDNSPod(const QString &ipv4, const QString &ipv6);
-    void updateDuckDNS(const QString &ipv4, const QString &ipv6);
+    QJsonObject providerConfig(const QString &provider) const;
+    QStringList selectedProviders() const;
 
     NetworkWidget *networkWidget;
 
-    std::shared_ptr<Cloudflare> cloudflare_;
-
     QComboBox *providerCombo;
+    QMap<QString, QCheckBox *> targetCheckBoxes;
+    QLabel *statusLabel;
     QStackedWidget *stackedWidget;
 
     // IP address labels
@@ -66,39 +81,42 @@ private:
     QLabel *ipv6Label;
     QCheckBox *ipv4CheckBox;
     QCheckBox *ipv6CheckBox;
+    QLabel *dampingLabel;
     QLineEdit *ipv4RecordName;    // IPv4记录名
     QLineEdit *ipv6RecordName;    // IPv6记录名
     // 用于存储记录ID的变量
     QString ipv4RecordId;
     QString ipv6RecordId;
 
-    QTimer *ipUpdateTimer;
+    // 先于服务构造，计入服务初始化的耗时
+    QElapsedTimer startupTimer;
     QNetworkAccessManager *networkManager;
+    DdnsService *service;
 
     QPushButton *ddnsButton;
-    QTimer *ddnsTimer;
-    bool ddnsRunning;
-    QString currentIPv4;
-    QString currentIPv6;
+
+    // 已创建的服务商页面
+    QSet<QString> builtPages;
+    bool firstFrameShown = false;
 
     // Cloudflare inputs
-    QLineEdit *cfEmail;
-    QLineEdit *cfApiKey;
-    QLineEdit *cfZoneId;
-    QLineEdit *cfDomain;
+    QLineEdit *cfEmail = nullptr;
+    QLineEdit *cfApiKey = nullptr;
+    QLineEdit *cfZoneId = nullptr;
+    QLineEdit *cfDomain = nullptr;
 
     // Aliyun inputs
-    QLineEdit *aliyunAccessKey;
-    QLineEdit *aliyunSecretKey;
-    QLineEdit *aliyunDomain;
+    QLineEdit *aliyunAccessKey = nullptr;
+    QLineEdit *aliyunSecretKey = nullptr;
+    QLineEdit *aliyunDomain = nullptr;
 
     // DNSPod inputs
-    QLineEdit *dnspodToken;
-    QLineEdit *dnspodDomain;
+    QLineEdit *dnspodToken = nullptr;
+    QLineEdit *dnspodDomain = nullptr;
 
     // DuckDNS inputs
-    QLineEdit *duckdnsToken;
-    QLineEdit *duckdnsDomain;
+    QLineEdit *duckdnsToken = nullptr;
+    QLineEdit *duckdnsDomain = nullptr;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,462 @@
+#include "mockapiserver.h"
+
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QUrl>
+#include <QDebug>
+
+// 请求头上限，防止异常客户端无限占用内存
+static const int MAX_HEADER_SIZE = 16 * 1024;
+
+static QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    default: return "Error";
+    }
+}
+
+static QByteArray toJson(const QJsonObject &obj)
+{
+    return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+MockApiServer::MockApiServer(QObject *parent)
+    : QObject(parent)
+    , server_(new QTcpServer(this))
+{
+    connect(server_, &QTcpServer::newConnection, this, &MockApiServer::onNewConnection);
+}
+
+bool MockApiServer::listen(quint16 port)
+{
+    // 只监听本机
+    if (!server_->listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "mock API listen failed:" << server_->errorString();
+        return false;
+    }
+    qInfo() << QString("mock API listening on http://127.0.0.1:%1/").arg(server_->serverPort());
+    return true;
+}
+
+void MockApiServer::onNewConnection()
+{
+    while (QTcpSocket *socket = server_->nextPendingConnection()) {
+        ++connections_;
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            buffers_.remove(socket);
+            socket->deleteLater();
+        });
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            onReadyRead(socket);
+        });
+    }
+}
+
+void MockApiServer::onReadyRead(QTcpSocket *socket)
+{
+    QByteArray &buffer = buffers_[socket];
+    buffer.append(socket->readAll());
+
+    // 同一连接上可能连续发来多个请求
+    while (true) {
+        const int headerEnd = buffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            if (buffer.size() > MAX_HEADER_SIZE) {
+                socket->disconnectFromHost();
+            }
+            return;
+        }
+
+        const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+        const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+        if (requestLine.size() != 3) {
+            socket->disconnectFromHost();
+            return;
+        }
+
+        int contentLength = 0;
+        QByteArray authorization;
+        bool keepAlive = requestLine.at(2) == "HTTP/1.1";
+        for (int i = 1; i < lines.size(); ++i) {
+            const QByteArray line = lines.at(i).trimmed();
+            const int colon = line.indexOf(':');
+            if (colon < 0) {
+                continue;
+            }
+            const QByteArray name = line.left(colon).trimmed().toLower();
+            const QByteArray value = line.mid(colon + 1).trimmed().toLower();
+            if (name == "authorization") {
+                // 令牌区分大小写
+                authorization = line.mid(colon + 1).trimmed();
+            } else if (name == "content-length") {
+                contentLength = value.toInt();
+            } else if (name == "connection") {
+                keepAlive = value != "close";
+            }
+        }
+
+        const int requestSize = headerEnd + 4 + contentLength;
+        if (buffer.size() < requestSize) {
+            return;
+        }
+        const QByteArray body = buffer.mid(headerEnd + 4, contentLength);
+        buffer.remove(0, requestSize);
+
+        ++requests_;
+        const QUrl url = QUrl::fromEncoded(requestLine.at(1));
+        const Response response = handleRequest(requestLine.at(0), url, body, authorization);
+
+        QByteArray out = "HTTP/1.1 " + QByteArray::number(response.status) + " " + reasonPhrase(response.status) + "\r\n";
+        out += "Content-Type: application/json\r\n";
+        out += "Content-Length: " + QByteArray::number(response.body.size()) + "\r\n";
+        out += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+        out += response.body;
+        socket->write(out);
+
+        if (!keepAlive) {
+            socket->disconnectFromHost();
+            return;
+        }
+    }
+}
+
+MockApiServer::Response MockApiServer::handleRequest(const QByteArray &method, const QUrl &url, const QByteArray &body,
+                                                     const QByteArray &authorization)
+{
+    qInfo() << "mock API:" << method << url.path();
+
+    if (url.path().startsWith("/zones/")) {
+        // 不校验令牌内容，只要求带上令牌
+        if (!authorization.startsWith("Bearer ") || authorization.size() <= 7) {
+            return cloudflareError(401, 10000, "Authentication error");
+        }
+        return handleCloudflare(method, url, body);
+    }
+
+    const QUrlQuery query(url);
+    if (method == "GET" && query.hasQueryItem("Action")) {
+        return handleAliyun(query);
+    }
+    if (method == "POST" && url.path().startsWith("/Record.")) {
+        // 表单里的 + 表示空格
+        return handleDnsPod(url.path().mid(1), QUrlQuery(QString::fromUtf8(body).replace('+', ' ')));
+    }
+
+    Response response;
+    response.status = 404;
+    response.body = toJson({{"error", "not found"}});
+    return response;
+}
+
+MockApiServer::Response MockApiServer::aliyunError(int status, const QString &code, const QString &message)
+{
+    Response response;
+    response.status = status;
+    response.body = toJson({{"Code", code}, {"Message", message}, {"RequestId", "mock"}});
+    return response;
+}
+
+MockApiServer::Response MockApiServer::handleAliyun(const QUrlQuery &query)
+{
+    // 不校验签名内容，只要求请求带上凭据和签名
+    if (query.queryItemValue("AccessKeyId").isEmpty() || query.queryItemValue("Signature").isEmpty()) {
+        return aliyunError(400, "MissingParameter", "AccessKeyId and Signature are required");
+    }
+
+    auto value = [&query](const QString &key) {
+        return query.queryItemValue(key, QUrl::FullyDecoded);
+    };
+    const QString action = value("Action");
+    Response response;
+
+    if (action == "DescribeSubDomainRecords") {
+        const QString subDomain = value("SubDomain");
+        const QString type = value("Type");
+        QJsonArray result;
+        for (const Record &record : std::as_const(records_)) {
+            if (record.rr + "." + record.domain == subDomain && (type.isEmpty() || record.type == type)) {
+                result.append(QJsonObject{{"RecordId", record.id}, {"RR", record.rr},
+                                          {"DomainName", record.domain}, {"Type", record.type},
+                                          {"Value", record.value}, {"TTL", record.ttl}});
+            }
+        }
+        response.body = toJson({{"TotalCount", int(result.size())},
+                                {"DomainRecords", QJsonObject{{"Record", result}}},
+                                {"RequestId", "mock"}});
+        return response;
+    }
+
+    if (action == "AddDomainRecord") {
+        Record record;
+        record.domain = value("DomainName");
+        record.rr = value("RR");
+        record.type = value("Type");
+        record.value = value("Value");
+        record.ttl = query.hasQueryItem("TTL") ? value("TTL").toInt() : 600;
+        for (const Record &existing : std::as_const(records_)) {
+            if (existing.domain == record.domain && existing.rr == record.rr
+                && existing.type == record.type && existing.value == record.value) {
+                return aliyunError(400, "DomainRecordDuplicate", "The DNS record already exists.");
+            }
+        }
+        record.id = QString::number(nextId_++);
+        records_.insert(record.id, record);
+        response.body = toJson({{"RecordId", record.id}, {"RequestId", "mock"}});
+        return response;
+    }
+
+    if (action == "UpdateDomainRecord") {
+        auto it = records_.find(value("RecordId"));
+        if (it == records_.end()) {
+            return aliyunError(400, "DomainRecordNotBelongToUser", "The DNS record does not belong to the user.");
+        }
+        const int ttl = query.hasQueryItem("TTL") ? value("TTL").toInt() : it->ttl;
+        if (it->rr == value("RR") && it->type == value("Type") && it->value == value("Value") && it->ttl == ttl) {
+            return aliyunError(400, "DomainRecordDuplicate", "The DNS record already exists.");
+        }
+        it->rr = value("RR");
+        it->type = value("Type");
+        it->value = value("Value");
+        it->ttl = ttl;
+        response.body = toJson({{"RecordId", it->id}, {"RequestId", "mock"}});
+        return response;
+    }
+
+    return aliyunError(400, "InvalidAction.NotFound", QString("Unknown action %1").arg(action));
+}
+
+MockApiServer::Response MockApiServer::dnspodStatus(const QString &code, const QString &message, const QJsonObject &extra)
+{
+    // DNSPod 出错时 HTTP 状态仍为 200，结果在 status.code 中
+    QJsonObject obj = extra;
+    obj["status"] = QJsonObject{{"code", code}, {"message", message}};
+
+    Response response;
+    response.body = toJson(obj);
+    return response;
+}
+
+MockApiServer::Response MockApiServer::handleDnsPod(const QString &action, const QUrlQuery &form)
+{
+    auto value = [&form](const QString &key) {
+        return form.queryItemValue(key, QUrl::FullyDecoded);
+    };
+    if (value("login_token").isEmpty()) {
+        return dnspodStatus("-1", "Login failed");
+    }
+
+    const QString domain = value("domain");
+    // DNSPod 的数字字段以字符串返回
+    auto recordJson = [](const Record &record) {
+        return QJsonObject{{"id", record.id}, {"name", record.rr}, {"type", record.type},
+                           {"value", record.value}, {"ttl", QString::number(record.ttl)}, {"line_id", "0"}};
+    };
+
+    if (action == "Record.List") {
+        QJsonArray result;
+        for (const Record &record : std::as_const(records_)) {
+            if (record.domain == domain && record.rr == value("sub_domain")
+                && (!form.hasQueryItem("record_type") || record.type == value("record_type"))) {
+                result.append(recordJson(record));
+            }
+        }
+        if (result.isEmpty()) {
+            return dnspodStatus("10", "No records");
+        }
+        return dnspodStatus("1", "Action completed successful", {{"records", result}});
+    }
+
+    if (action == "Record.Create") {
+        Record record;
+        record.domain = domain;
+        record.rr = value("sub_domain");
+        record.type = value("record_type");
+        record.value = value("value");
+        record.ttl = form.hasQueryItem("ttl") ? value("ttl").toInt() : 600;
+        for (const Record &existing : std::as_const(records_)) {
+            if (existing.domain == record.domain && existing.rr == record.rr
+                && existing.type == record.type && existing.value == record.value) {
+                return dnspodStatus("104", "Record already exists");
+            }
+        }
+        record.id = QString::number(nextId_++);
+        records_.insert(record.id, record);
+        return dnspodStatus("1", "Action completed successful", {{"record", QJsonObject{{"id", record.id}}}});
+    }
+
+    if (action == "Record.Modify" || action == "Record.Ddns") {
+        auto it = records_.find(value("record_id"));
+        if (it == records_.end() || it->domain != domain) {
+            return dnspodStatus("8", "Record id invalid");
+        }
+        if (action == "Record.Ddns" && it->type != "A") {
+            return dnspodStatus("-15", "Record.Ddns only supports A records");
+        }
+        it->rr = value("sub_domain");
+        it->value = value("value");
+        if (action == "Record.Modify") {
+            it->type = value("record_type");
+            it->ttl = form.hasQueryItem("ttl") ? value("ttl").toInt() : it->ttl;
+        }
+        return dnspodStatus("1", "Action completed successful", {{"record", recordJson(*it)}});
+    }
+
+    return dnspodStatus("-1", QString("Unknown action %1").arg(action));
+}
+
+MockApiServer::Response MockApiServer::cloudflareResult(const QJsonValue &result)
+{
+    Response response;
+    response.body = toJson({{"result", result}, {"success", true},
+                            {"errors", QJsonArray()}, {"messages", QJsonArray()}});
+    return response;
+}
+
+MockApiServer::Response MockApiServer::cloudflareError(int status, int code, const QString &message)
+{
+    Response response;
+    response.status = status;
+    response.body = toJson({{"result", QJsonValue()}, {"success", false},
+                            {"errors", QJsonArray{QJsonObject{{"code", code}, {"message", message}}}},
+                            {"messages", QJsonArray()}});
+    return response;
+}
+
+QJsonObject MockApiServer::cloudflareRecord(const Record &record)
+{
+    // Cloudflare 记录的 name 为完整域名，这里存放在 rr 中，domain 存放区域ID
+    return QJsonObject{{"id", record.id}, {"zone_id", record.domain}, {"name", record.rr},
+                       {"type", record.type}, {"content", record.value}, {"ttl", record.ttl},
+                       {"proxied", false}};
+}
+
+MockApiServer::Response MockApiServer::handleCloudflare(const QByteArray &method, const QUrl &url, const QByteArray &body)
+{
+    // /zones/<zone>/dns_records[/<id>|/batch]
+    const QStringList parts = url.path().split('/', Qt::SkipEmptyParts);
+    if (parts.size() < 3 || parts.size() > 4 || parts.at(2) != "dns_records") {
+        return cloudflareError(404, 7003, "Could not route to " + url.path());
+    }
+    const QString zone = parts.at(1);
+    const QJsonDocument doc = QJsonDocument::fromJson(body);
+
+    auto fill = [](Record &record, const QJsonObject &fields) {
+        record.rr = fields["name"].toString(record.rr);
+        record.type = fields["type"].toString(record.type);
+        record.value = fields["content"].toString(record.value);
+        record.ttl = fields["ttl"].toInt(record.ttl);
+    };
+    auto create = [this, &zone, &fill](const QJsonObject &fields, QJsonObject &created) {
+        Record record;
+        record.domain = zone;
+        record.ttl = 1;
+        fill(record, fields);
+        for (const Record &existing : std::as_const(records_)) {
+            if (existing.domain == zone && existing.rr == record.rr
+                && existing.type == record.type && existing.value == record.value) {
+                return false;
+            }
+        }
+        record.id = QString::number(nextId_++);
+        records_.insert(record.id, record);
+        created = cloudflareRecord(record);
+        return true;
+    };
+    auto update = [this, &zone, &fill](const QString &id, const QJsonObject &fields, QJsonObject &updated) {
+        auto it = records_.find(id);
+        if (it == records_.end() || it->domain != zone) {
+            return false;
+        }
+        fill(*it, fields);
+        updated = cloudflareRecord(*it);
+        return true;
+    };
+
+    if (parts.size() == 3 && method == "GET") {
+        const QUrlQuery query(url);
+        const QString type = query.queryItemValue("type", QUrl::FullyDecoded);
+        const QString name = query.queryItemValue("name", QUrl::FullyDecoded);
+        const int perPage = qMax(1, query.hasQueryItem("per_page") ? query.queryItemValue("per_page").toInt() : 100);
+        const int page = qMax(1, query.hasQueryItem("page") ? query.queryItemValue("page").toInt() : 1);
+
+        QList<Record> matched;
+        for (const Record &record : std::as_const(records_)) {
+            if (record.domain == zone && (type.isEmpty() || record.type == type)
+                && (name.isEmpty() || record.rr == name)) {
+                matched.append(record);
+            }
+        }
+        QJsonArray result;
+        for (int i = (page - 1) * perPage; i < matched.size() && i < page * perPage; ++i) {
+            result.append(cloudflareRecord(matched.at(i)));
+        }
+        const int totalPages = qMax(1, int((matched.size() + perPage - 1) / perPage));
+
+        Response response = cloudflareResult(result);
+        QJsonObject obj = QJsonDocument::fromJson(response.body).object();
+        obj["result_info"] = QJsonObject{{"page", page}, {"per_page", perPage}, {"count", int(result.size())},
+                                         {"total_count", int(matched.size())}, {"total_pages", totalPages}};
+        response.body = toJson(obj);
+        return response;
+    }
+
+    if (parts.size() == 3 && method == "POST") {
+        QJsonObject created;
+        if (!create(doc.object(), created)) {
+            return cloudflareError(400, 81057, "Record already exists.");
+        }
+        return cloudflareResult(created);
+    }
+
+    if (parts.size() == 4 && parts.at(3) == "batch" && method == "POST") {
+        // 批量请求是原子的：先检查全部修改，再一起生效
+        const QJsonArray patches = doc.object()["patches"].toArray();
+        for (const QJsonValue &patch : patches) {
+            const auto it = records_.constFind(patch.toObject()["id"].toString());
+            if (it == records_.constEnd() || it->domain != zone) {
+                return cloudflareError(404, 81044, "Record does not exist.");
+            }
+        }
+        QJsonArray patched;
+        for (const QJsonValue &patch : patches) {
+            QJsonObject updated;
+            update(patch.toObject()["id"].toString(), patch.toObject(), updated);
+            patched.append(updated);
+        }
+        QJsonArray posted;
+        for (const QJsonValue &post : doc.object()["posts"].toArray()) {
+            QJsonObject created;
+            if (create(post.toObject(), created)) {
+                posted.append(created);
+            }
+        }
+        return cloudflareResult(QJsonObject{{"patches", patched}, {"posts", posted},
+                                            {"puts", QJsonArray()}, {"deletes", QJsonArray()}});
+    }
+
+    if (parts.size() == 4 && method == "PUT") {
+        QJsonObject updated;
+        if (!update(parts.at(3), doc.object(), updated)) {
+            return cloudflareError(404, 81044, "Record does not exist.");
+        }
+        return cloudflareResult(updated);
+    }
+
+    if (parts.size() == 4 && method == "DELETE") {
+        auto it = records_.find(parts.at(3));
+        if (it == records_.end() || it->domain != zone) {
+            return cloudflareError(404, 81044, "Record does not exist.");
+        }
+        records_.erase(it);
+        return cloudflareResult(QJsonObject{{"id", parts.at(3)}});
+    }
+
+    return cloudflareError(405, 10000, QString("Method %1 not allowed").arg(QString::fromLatin1(method)));
+}
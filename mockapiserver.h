@@ -0,0 +1,78 @@
+#ifndef MOCKAPISERVER_H
+#define MOCKAPISERVER_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QUrlQuery>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QJsonObject>
+
+// 本地模拟的服务商 HTTP 接口，把服务商的 endpoint 指向它即可离线测试
+//
+// 只实现 HTTP/1.1 的最小子集（支持 keep-alive），记录保存在内存中。
+// 目前模拟：
+//   阿里云解析   GET  ?Action=DescribeSubDomainRecords / AddDomainRecord / UpdateDomainRecord
+//   DNSPod       POST /Record.List / Record.Create / Record.Modify / Record.Ddns
+//   Cloudflare   /zones/<zone>/dns_records 的查询、创建、修改、删除和 /batch 批量写入
+class MockApiServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MockApiServer(QObject *parent = nullptr);
+
+    bool listen(quint16 port);
+    quint16 port() const { return server_->serverPort(); }
+
+    // 收到的请求数和建立的连接数，用于确认连接复用
+    int requestCount() const { return requests_; }
+    int connectionCount() const { return connections_; }
+
+private:
+    struct Response
+    {
+        int status = 200;
+        QByteArray body;
+    };
+
+    struct Record
+    {
+        QString id;
+        QString domain;
+        QString rr;
+        QString type;
+        QString value;
+        int ttl = 600;
+    };
+
+    void onNewConnection();
+    void onReadyRead(QTcpSocket *socket);
+    Response handleRequest(const QByteArray &method, const QUrl &url, const QByteArray &body,
+                           const QByteArray &authorization);
+
+    Response handleAliyun(const QUrlQuery &query);
+    static Response aliyunError(int status, const QString &code, const QString &message);
+
+    Response handleDnsPod(const QString &action, const QUrlQuery &form);
+    static Response dnspodStatus(const QString &code, const QString &message, const QJsonObject &extra = QJsonObject());
+
+    Response handleCloudflare(const QByteArray &method, const QUrl &url, const QByteArray &body);
+    static Response cloudflareResult(const QJsonValue &result);
+    static Response cloudflareError(int status, int code, const QString &message);
+    static QJsonObject cloudflareRecord(const Record &record);
+
+private:
+    QTcpServer *server_;
+    // 各连接尚未处理完的数据
+    QHash<QTcpSocket *, QByteArray> buffers_;
+
+    QMap<QString, Record> records_;
+    int nextId_ = 1000;
+    int requests_ = 0;
+    int connections_ = 0;
+};
+
+#endif // MOCKAPISERVER_H
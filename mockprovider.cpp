@@ -0,0 +1,66 @@
+#include "mockprovider.h"
+#include "timerwheel.h"
+
+#include <QRandomGenerator>
+#include <QDebug>
+
+bool MockProvider::loadConfig(const QJsonObject &config, QString &error)
+{
+    Q_UNUSED(error);
+    latency_ = qMax(0, config["latency"].toInt(200));
+    failureRate_ = qBound(0.0, config["failure_rate"].toDouble(0), 1.0);
+    return true;
+}
+
+void MockProvider::call(std::function<void(bool success)> done)
+{
+    const quint64 cycle = this->cycle();
+    const bool success = failureRate_ <= 0 || QRandomGenerator::global()->generateDouble() >= failureRate_;
+    TimerWheel::getInstance().schedule(latency_, this, [this, cycle, success, done]() {
+        // 已被取代或中止的轮次
+        if (this->cycle() == 0 || this->cycle() != cycle) {
+            return;
+        }
+        done(success);
+    });
+}
+
+void MockProvider::updateDnsRecords(const QList<DnsRecord> &records)
+{
+    if (records.isEmpty()) {
+        emit updateFinished(true, "nothing to update");
+        return;
+    }
+
+    ++searchCalls_;
+    call([this, records](bool success) {
+        if (!success) {
+            emit updateFinished(false, "search failed");
+            return;
+        }
+
+        QList<DnsRecord> changed;
+        for (const DnsRecord &record : records) {
+            if (content(record.type, record.name) != record.content) {
+                changed.append(record);
+            }
+        }
+        if (changed.isEmpty()) {
+            emit updateFinished(true, QString("%1 record(s) unchanged").arg(records.size()));
+            return;
+        }
+
+        ++writeCalls_;
+        call([this, changed](bool success) {
+            if (!success) {
+                emit updateFinished(false, "write failed");
+                return;
+            }
+            for (const DnsRecord &record : changed) {
+                records_.insert(record.type + " " + record.name, record.content);
+                emit recordPublished(record);
+            }
+            emit updateFinished(true, QString("updated %1").arg(changed.size()));
+        });
+    });
+}
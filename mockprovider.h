@@ -0,0 +1,43 @@
+#ifndef MOCKPROVIDER_H
+#define MOCKPROVIDER_H
+
+#include <QString>
+#include <QHash>
+#include <QJsonObject>
+
+#include "dnsprovider.h"
+
+// 本地模拟服务商：记录保存在内存中，按虚拟延迟异步应答，用于模拟和基准测试
+//
+// 每次更新模拟一次查询调用，有变化时再模拟一次批量写入调用。
+class MockProvider : public DnsProvider
+{
+    Q_OBJECT
+public:
+    MockProvider(RequestManager *requestManager) : DnsProvider(requestManager) {};
+
+    QString name() const override { return "Mock"; }
+    bool loadConfig(const QJsonObject &config, QString &error) override;
+
+    void updateDnsRecords(const QList<DnsRecord> &records) override;
+
+    QString content(const QString &type, const QString &name) const { return records_.value(type + " " + name); }
+    quint64 searchCalls() const { return searchCalls_; }
+    quint64 writeCalls() const { return writeCalls_; }
+
+signals:
+    void recordPublished(const DnsRecord &record);
+
+private:
+    // 模拟一次 API 调用，失败率按配置随机
+    void call(std::function<void(bool success)> done);
+
+private:
+    QHash<QString, QString> records_;
+    int latency_ = 200;
+    double failureRate_ = 0;
+    quint64 searchCalls_ = 0;
+    quint64 writeCalls_ = 0;
+};
+
+#endif // MOCKPROVIDER_H
@@ -1,5 +1,6 @@
 // networkwidget.cpp
 #include "networkwidget.h"
+#include "uplinkdiscovery.h"
 
 NetworkWidget::NetworkWidget(QWidget *parent)
     : QWidget(parent)
@@ -32,17 +33,10 @@ void NetworkWidget::refreshNetworkInterfaces()
 {
     interfaceComboBox->clear();
 
-    // 获取所有网络接口
-    QList<QNetworkInterface> interfaces = QNetworkInterface::allInterfaces();
+    // 与多出口发现使用相同的接口列表
+    QList<QNetworkInterface> interfaces = UplinkDiscovery::usableInterfaces();
 
     foreach(const QNetworkInterface &interface, interfaces) {
-        // 跳过禁用的接口和回环接口
-        if(!(interface.flags() & QNetworkInterface::IsUp) ||
-            !(interface.flags() & QNetworkInterface::IsRunning) ||
-            (interface.flags() & QNetworkInterface::IsLoopBack)) {
-            continue;
-        }
-
         // 获取接口信息组装显示文本
         QString displayText = interface.name() + " - " + interface.humanReadableName();
 
@@ -0,0 +1,138 @@
+#include "oncerunner.h"
+#include "config.h"
+
+#include "timerwheel.h"
+
+#include <QTextStream>
+#include <QDebug>
+
+OnceRunner::OnceRunner(const QString &record, int deadline, bool force, QObject *parent)
+    : QObject(parent)
+    , record_(record)
+    , deadline_(deadline)
+    , force_(force)
+    , networkManager_(new QNetworkAccessManager(this))
+{
+}
+
+int OnceRunner::run()
+{
+    elapsed_.start();
+
+    if (Config::getInstance().init() != 0) {
+        finish(ConfigError, "could not load configuration");
+        return ConfigError;
+    }
+
+    // 只构造服务本身：不打开日志、不监测连通性、不监听推送接口，
+    // 故障切换只在要更新的记录包含切换组时探测
+    service_ = new DdnsService(networkManager_, this);
+    // 钩子在地址变化时调用，常驻实例未必已经察觉，必须自己发现并写入
+    service_->setCoordinated(false);
+    service_->reloadConfig();
+    // 单次运行没有稳定窗口可等，发现的地址直接使用
+    service_->setDampingEnabled(false);
+    service_->setRecordFilter(record_);
+    // 与上次成功写入的内容相同则不调用服务商接口
+    service_->setSkipPublished(!force_);
+    setupMs_ = elapsed_.elapsed();
+
+    QStringList configErrors;
+    connect(service_, &DdnsService::configError, this, [&configErrors](const QString &message) {
+        qWarning() << message;
+        configErrors.append(message);
+    });
+    connect(service_, &DdnsService::updateSkipped, this, [this](const QString &reason) {
+        finish(DiscoveryError, reason);
+    });
+    connect(service_, &DdnsService::upToDate, this, [this, &configErrors]() {
+        if (configErrors.isEmpty()) {
+            finish(Success, "already up to date");
+        }
+    });
+    connect(service_, &DdnsService::updateQueued, this, [this](int providers) {
+        finish(UpdateError, QString("offline, %1 provider(s) queued").arg(providers));
+    });
+    connect(service_->dispatcher(), &UpdateDispatcher::cycleFinished, this,
+            [this, &configErrors](bool success, const QList<ProviderStatus> &statuses) {
+        QStringList lines;
+        for (const ProviderStatus &s : statuses) {
+            lines.append(QString("%1: %2 %3").arg(s.provider).arg(s.success ? "OK" : "FAILED").arg(s.message));
+        }
+        if (!configErrors.isEmpty()) {
+            lines.append(configErrors);
+            finish(ConfigError, lines.join("; "));
+            return;
+        }
+        finish(success ? Success : UpdateError, lines.join("; "));
+    });
+
+    // 默认出口、各出口和故障切换的首轮探测都返回后才开始更新
+    Failover *failover = service_->failover();
+    const bool needFailover = !failover->isEmpty() && (record_.isEmpty() || failover->recordNames().contains(record_));
+    bool addressesDone = false;
+    bool uplinksDone = service_->uplinks()->isEmpty();
+    bool failoverDone = !needFailover;
+
+    auto update = [this, &configErrors, &addressesDone, &uplinksDone, &failoverDone]() {
+        if (finished_ || !addressesDone || !uplinksDone || !failoverDone) {
+            return;
+        }
+        if (service_->address(true).isEmpty() && service_->address(false).isEmpty()
+            && service_->uplinks()->records().isEmpty() && service_->failover()->records().isEmpty()) {
+            finish(DiscoveryError, "no public address discovered");
+            return;
+        }
+
+        // 更新使用剩余的时间预算
+        int remaining = deadline_ - int(elapsed_.elapsed());
+        service_->dispatcher()->setCycleBudget(qMax(1000, remaining));
+        service_->updateDNS();
+
+        // 没有发起任何请求（配置错误等）
+        if (!finished_ && !service_->dispatcher()->isRunning()) {
+            finish(configErrors.isEmpty() ? Success : ConfigError, configErrors.join("; "));
+        }
+    };
+
+    connect(service_, &DdnsService::discoveryFinished, this, [&addressesDone, update]() {
+        addressesDone = true;
+        update();
+    });
+    connect(service_->uplinks(), &UplinkDiscovery::finished, this, [&uplinksDone, update]() {
+        uplinksDone = true;
+        update();
+    });
+    connect(failover, &Failover::roundFinished, this, [failover, &failoverDone, update]() {
+        if (!failoverDone && failover->isSettled()) {
+            failoverDone = true;
+            update();
+        }
+    });
+
+    TimerWheel::getInstance().schedule(deadline_, this, [this]() {
+        service_->stop();
+        finish(DeadlineExceeded, "deadline exceeded");
+    });
+
+    if (needFailover) {
+        failover->start();
+    }
+    service_->refreshAddresses(deadline_);
+    return loop_.exec();
+}
+
+void OnceRunner::finish(ExitCode code, const QString &message)
+{
+    if (finished_) {
+        return;
+    }
+    finished_ = true;
+
+    // 总耗时中初始化服务所占的部分
+    QTextStream(stdout) << QString("%1 (%2 ms, setup %3 ms): %4\n").arg(code == Success ? "ok" : "error")
+                                                                   .arg(elapsed_.elapsed())
+                                                                   .arg(setupMs_)
+                                                                   .arg(message);
+    loop_.exit(code);
+}
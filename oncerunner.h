@@ -0,0 +1,46 @@
+#ifndef ONCERUNNER_H
+#define ONCERUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+
+#include "ddnsservice.h"
+
+// 命令行单次运行：发现地址、更新一轮后退出，供 cron 和 ip-up 钩子调用
+class OnceRunner : public QObject
+{
+    Q_OBJECT
+public:
+    enum ExitCode {
+        Success = 0,
+        ConfigError = 1,
+        DiscoveryError = 2,
+        UpdateError = 3,
+        DeadlineExceeded = 4,
+    };
+
+    OnceRunner(const QString &record, int deadline, bool force, QObject *parent = nullptr);
+
+    int run();
+
+private:
+    void finish(ExitCode code, const QString &message);
+
+private:
+    QString record_;
+    int deadline_;
+    bool force_;
+
+    QEventLoop loop_;
+    QElapsedTimer elapsed_;
+    QNetworkAccessManager *networkManager_;
+    DdnsService *service_ = nullptr;
+    bool finished_ = false;
+    // 加载配置和构造服务的耗时
+    qint64 setupMs_ = 0;
+};
+
+#endif // ONCERUNNER_H
@@ -0,0 +1,99 @@
+#include "pendingqueue.h"
+
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QSaveFile>
+#include <QDebug>
+
+QString PendingQueue::getQueueFilePath() const
+{
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir dir(dataPath);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    return dataPath + "/pending.json";
+}
+
+bool PendingQueue::load()
+{
+    QFile file(getQueueFilePath());
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open pending queue for reading:" << file.errorString();
+        return false;
+    }
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (doc.isNull()) {
+        qWarning() << "Failed to parse pending queue:" << error.errorString();
+        return false;
+    }
+
+    QJsonObject obj = doc.object();
+    providers_.clear();
+    const QJsonArray providers = obj["providers"].toArray();
+    for (const QJsonValue &value : providers) {
+        providers_.append(value.toString());
+    }
+    desired_.ipv4 = obj["ipv4"].toString();
+    desired_.ipv6 = obj["ipv6"].toString();
+    desired_.ipv4RecordName = obj["ipv4_record"].toString();
+    desired_.ipv6RecordName = obj["ipv6_record"].toString();
+    desired_.queuedAt = QDateTime::fromString(obj["queued_at"].toString(), Qt::ISODate);
+    return true;
+}
+
+bool PendingQueue::save() const
+{
+    QJsonObject obj;
+    obj["providers"] = QJsonArray::fromStringList(providers_);
+    obj["ipv4"] = desired_.ipv4;
+    obj["ipv6"] = desired_.ipv6;
+    obj["ipv4_record"] = desired_.ipv4RecordName;
+    obj["ipv6_record"] = desired_.ipv6RecordName;
+    obj["queued_at"] = desired_.queuedAt.toString(Qt::ISODate);
+
+    // 原子写入，避免断电后留下半个文件
+    QSaveFile file(getQueueFilePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not save pending queue:" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+void PendingQueue::enqueue(const QStringList &providers, const DesiredState &state)
+{
+    // 新状态覆盖旧状态，旧状态中尚未写入的服务商一并保留
+    desired_ = state;
+    if (!desired_.queuedAt.isValid()) {
+        desired_.queuedAt = QDateTime::currentDateTime();
+    }
+    for (const QString &provider : providers) {
+        if (!providers_.contains(provider)) {
+            providers_.append(provider);
+        }
+    }
+    save();
+}
+
+void PendingQueue::remove(const QString &provider)
+{
+    if (providers_.removeAll(provider) > 0) {
+        save();
+    }
+}
+
+void PendingQueue::clear()
+{
+    providers_.clear();
+    save();
+}
@@ -0,0 +1,40 @@
+#ifndef PENDINGQUEUE_H
+#define PENDINGQUEUE_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QJsonObject>
+
+// 离线期间待写入的期望状态；只保留最新一份，中间状态直接合并
+class PendingQueue
+{
+public:
+    struct DesiredState {
+        QString ipv4;
+        QString ipv6;
+        QString ipv4RecordName;
+        QString ipv6RecordName;
+        QDateTime queuedAt;
+    };
+
+    bool load();
+    bool save() const;
+
+    void enqueue(const QStringList &providers, const DesiredState &state);
+    void remove(const QString &provider);
+    void clear();
+
+    bool isEmpty() const { return providers_.isEmpty(); }
+    QStringList providers() const { return providers_; }
+    const DesiredState &desired() const { return desired_; }
+
+private:
+    QString getQueueFilePath() const;
+
+private:
+    QStringList providers_;
+    DesiredState desired_;
+};
+
+#endif // PENDINGQUEUE_H
@@ -0,0 +1,69 @@
+#include "prefixdelegation.h"
+
+#include <QJsonArray>
+#include <QDebug>
+
+void PrefixDelegation::loadConfig(const QJsonObject &config)
+{
+    templates_.clear();
+    prefixLength_ = qBound(1, config["prefix_length"].toInt(56), 127);
+
+    const QJsonArray records = config["records"].toArray();
+    for (const QJsonValue &value : records) {
+        const QJsonObject record = value.toObject();
+        const QString name = record["name"].toString().trimmed();
+        QHostAddress suffix(record["suffix"].toString().trimmed());
+        if (name.isEmpty() || suffix.protocol() != QAbstractSocket::IPv6Protocol) {
+            qWarning() << "invalid ipv6_prefix record ignored:" << record;
+            continue;
+        }
+        templates_.append({name, suffix.toIPv6Address()});
+    }
+}
+
+QStringList PrefixDelegation::recordNames() const
+{
+    QStringList names;
+    for (const Template &t : templates_) {
+        names.append(t.name);
+    }
+    return names;
+}
+
+QHostAddress PrefixDelegation::combine(const Q_IPV6ADDR &prefix, const Q_IPV6ADDR &suffix) const
+{
+    Q_IPV6ADDR result;
+    for (int i = 0; i < 16; ++i) {
+        // 该字节中属于前缀的位数
+        const int bits = qBound(0, prefixLength_ - i * 8, 8);
+        const quint8 mask = quint8(0xff << (8 - bits));
+        result[i] = quint8((prefix[i] & mask) | (suffix[i] & ~mask));
+    }
+    return QHostAddress(result);
+}
+
+QString PrefixDelegation::prefix(const QString &ipv6) const
+{
+    QHostAddress address(ipv6);
+    if (address.protocol() != QAbstractSocket::IPv6Protocol) {
+        return QString();
+    }
+
+    const Q_IPV6ADDR zero = {};
+    return QString("%1/%2").arg(combine(address.toIPv6Address(), zero).toString()).arg(prefixLength_);
+}
+
+QList<DnsRecord> PrefixDelegation::derive(const QString &ipv6) const
+{
+    QList<DnsRecord> records;
+    QHostAddress address(ipv6);
+    if (address.protocol() != QAbstractSocket::IPv6Protocol) {
+        return records;
+    }
+
+    const Q_IPV6ADDR prefix = address.toIPv6Address();
+    for (const Template &t : templates_) {
+        records.append({"AAAA", t.name, combine(prefix, t.suffix).toString()});
+    }
+    return records;
+}
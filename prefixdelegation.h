@@ -0,0 +1,46 @@
+#ifndef PREFIXDELEGATION_H
+#define PREFIXDELEGATION_H
+
+#include <QString>
+#include <QList>
+#include <QStringList>
+#include <QJsonObject>
+#include <QHostAddress>
+
+#include "dnsprovider.h"
+
+// IPv6 前缀委派：记录按后缀模板定义，前缀变化时在本地推导出全部 AAAA 记录
+//
+// "ipv6_prefix": {
+//     "prefix_length": 56,
+//     "records": [ { "name": "nas", "suffix": "::1:0:0:0:10" } ]
+// }
+// 后缀中前缀长度以内的位被忽略，其余位（子网号 + 接口ID）与探测到的前缀组合。
+class PrefixDelegation
+{
+public:
+    void loadConfig(const QJsonObject &config);
+
+    bool isEnabled() const { return !templates_.isEmpty(); }
+    QStringList recordNames() const;
+    int prefixLength() const { return prefixLength_; }
+
+    // 地址所在的委派前缀，例如 2001:db8:1200::/56
+    QString prefix(const QString &ipv6) const;
+    // 以 ipv6 的前缀推导出所有模板记录
+    QList<DnsRecord> derive(const QString &ipv6) const;
+
+private:
+    struct Template {
+        QString name;
+        Q_IPV6ADDR suffix;
+    };
+
+    QHostAddress combine(const Q_IPV6ADDR &prefix, const Q_IPV6ADDR &suffix) const;
+
+private:
+    int prefixLength_ = 56;
+    QList<Template> templates_;
+};
+
+#endif // PREFIXDELEGATION_H
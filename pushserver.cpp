@@ -0,0 +1,124 @@
+#include "pushserver.h"
+
+#include <QHostAddress>
+#include <QStringList>
+#include <QDebug>
+
+// 单行命令上限，防止异常客户端无限占用内存
+static const int MAX_LINE_LENGTH = 256;
+// 检查套接字是否仍有进程在监听的等待时间
+static const int PROBE_TIMEOUT = 500;
+
+PushServer::PushServer(QObject *parent)
+    : QObject(parent)
+    , server_(new QLocalServer(this))
+{
+    // 只允许当前用户连接
+    server_->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(server_, &QLocalServer::newConnection, this, &PushServer::onNewConnection);
+}
+
+bool PushServer::listen(const QString &name)
+{
+    close();
+
+    // 另一个实例正在监听时不能抢占它的套接字
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(PROBE_TIMEOUT)) {
+        probe.disconnectFromServer();
+        qWarning() << "push server not started:" << name << "is in use by another process";
+        return false;
+    }
+
+    // 无人应答，是上次异常退出留下的套接字文件
+    QLocalServer::removeServer(name);
+    if (!server_->listen(name)) {
+        qWarning() << "push server listen failed:" << server_->errorString();
+        return false;
+    }
+
+    qInfo() << "push server listening on" << server_->fullServerName();
+    return true;
+}
+
+void PushServer::close()
+{
+    if (server_->isListening()) {
+        server_->close();
+    }
+}
+
+void PushServer::onNewConnection()
+{
+    while (QLocalSocket *socket = server_->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, socket, &QLocalSocket::deleteLater);
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+            onReadyRead(socket);
+        });
+    }
+}
+
+void PushServer::onReadyRead(QLocalSocket *socket)
+{
+    // 已因超长行断开的连接，之后到达的数据一律丢弃
+    if (socket->state() != QLocalSocket::ConnectedState) {
+        socket->readAll();
+        return;
+    }
+    while (socket->canReadLine()) {
+        const QByteArray chunk = socket->readLine(MAX_LINE_LENGTH + 1);
+        // 没读到换行说明这一行超长，剩余部分不能当作下一条命令
+        if (!chunk.endsWith('\n')) {
+            rejectLongLine(socket);
+            return;
+        }
+        const QString line = QString::fromUtf8(chunk).trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        socket->write(handleCommand(line).toUtf8() + '\n');
+    }
+
+    if (socket->bytesAvailable() > MAX_LINE_LENGTH) {
+        rejectLongLine(socket);
+    }
+}
+
+void PushServer::rejectLongLine(QLocalSocket *socket)
+{
+    socket->write("ERR line too long\n");
+    // 已缓冲的内容不再处理
+    socket->readAll();
+    socket->disconnectFromServer();
+}
+
+QString PushServer::handleCommand(const QString &line)
+{
+    const QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+    const QString command = parts.first().toLower();
+
+    if (command == "update" && parts.size() == 1) {
+        if (!updateEnabled_) {
+            return "ERR DDNS is not running";
+        }
+        emit updateRequested();
+        return "OK";
+    }
+
+    if ((command == "ipv4" || command == "ipv6") && parts.size() == 2) {
+        const bool isIpv4 = command == "ipv4";
+        QHostAddress address(parts.at(1));
+        QAbstractSocket::NetworkLayerProtocol expected = isIpv4 ? QAbstractSocket::IPv4Protocol
+                                                                : QAbstractSocket::IPv6Protocol;
+        if (address.protocol() != expected) {
+            return QString("ERR invalid %1 address").arg(command);
+        }
+
+        qInfo() << "pushed" << command << address.toString();
+        emit addressPushed(isIpv4, address.toString());
+        return "OK";
+    }
+
+    return "ERR unknown command";
+}
@@ -0,0 +1,45 @@
+#ifndef PUSHSERVER_H
+#define PUSHSERVER_H
+
+#include <QObject>
+#include <QString>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+// 本地套接字推送接口，路由器等在地址变化时直接通知，省去外部查询
+//
+// 每行一条命令，回复 "OK" 或 "ERR <原因>"：
+//   ipv4 <address>
+//   ipv6 <address>
+//   update          立即执行一轮更新，DDNS 未开启时回复错误
+class PushServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PushServer(QObject *parent = nullptr);
+
+    // name 可以是名称（放在系统临时目录）或完整路径
+    bool listen(const QString &name);
+    void close();
+    bool isListening() const { return server_->isListening(); }
+    QString serverName() const { return server_->fullServerName(); }
+    // DDNS 未开启时 update 命令回复错误
+    void setUpdateEnabled(bool enabled) { updateEnabled_ = enabled; }
+
+signals:
+    void addressPushed(bool isIpv4, const QString &address);
+    void updateRequested();
+
+private:
+    void onNewConnection();
+    void onReadyRead(QLocalSocket *socket);
+    // 回复错误并断开，丢弃已收到的内容
+    void rejectLongLine(QLocalSocket *socket);
+    QString handleCommand(const QString &line);
+
+private:
+    QLocalServer *server_;
+    bool updateEnabled_ = false;
+};
+
+#endif // PUSHSERVER_H
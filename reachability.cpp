@@ -0,0 +1,52 @@
+#include "reachability.h"
+
+#include <QDebug>
+
+void Reachability::start()
+{
+    if (info_) {
+        return;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
+    bool loaded = QNetworkInformation::loadBackendByFeatures(QNetworkInformation::Feature::Reachability);
+#else
+    bool loaded = QNetworkInformation::load(QNetworkInformation::Feature::Reachability);
+#endif
+    if (!loaded || !QNetworkInformation::instance()) {
+        qWarning("No network reachability backend, offline detection disabled");
+        return;
+    }
+
+    info_ = QNetworkInformation::instance();
+    online_ = info_->reachability() == QNetworkInformation::Reachability::Online
+              || info_->reachability() == QNetworkInformation::Reachability::Unknown;
+    connect(info_, &QNetworkInformation::reachabilityChanged, this, &Reachability::onReachabilityChanged);
+}
+
+bool Reachability::isOnline() const
+{
+    return online_;
+}
+
+void Reachability::onReachabilityChanged(QNetworkInformation::Reachability reachability)
+{
+    // Site 级别（只有局域网）对 DDNS 来说等同于离线
+    setOnline(reachability == QNetworkInformation::Reachability::Online
+              || reachability == QNetworkInformation::Reachability::Unknown);
+}
+
+void Reachability::setOnline(bool isUp)
+{
+    if (isUp == online_) {
+        return;
+    }
+
+    online_ = isUp;
+    qInfo() << "network reachability changed:" << (isUp ? "online" : "offline");
+    if (isUp) {
+        emit online();
+    } else {
+        emit offline();
+    }
+}
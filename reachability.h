@@ -0,0 +1,34 @@
+#ifndef REACHABILITY_H
+#define REACHABILITY_H
+
+#include <QObject>
+#include <QNetworkInformation>
+
+// 基于 QNetworkInformation 的连通性监测；没有可用后端时视为始终在线
+class Reachability : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Reachability(QObject *parent = nullptr) : QObject(parent) {}
+
+    // 加载系统的连通性后端并开始监测；未调用时视为始终在线（单次运行、模拟模式）
+    void start();
+
+    bool isAvailable() const { return info_ != nullptr; }
+    bool isOnline() const;
+    // 模拟模式下直接设置连通状态
+    void setOnline(bool isUp);
+
+signals:
+    void online();
+    void offline();
+
+private:
+    void onReachabilityChanged(QNetworkInformation::Reachability reachability);
+
+private:
+    QNetworkInformation *info_ = nullptr;
+    bool online_ = true;
+};
+
+#endif // REACHABILITY_H
@@ -0,0 +1,391 @@
+#include "recordlistparser.h"
+
+#include <cstring>
+
+// 嵌套层数上限，防止异常数据耗尽内存
+static const int MAX_DEPTH = 64;
+
+static bool isNumberChar(char c)
+{
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void RecordListParser::reset()
+{
+    stack_.clear();
+    token_ = NoToken;
+    tokenIsKey_ = false;
+    escape_ = false;
+    unicodeDigits_ = 0;
+    highSurrogate_ = 0;
+    target_ = nullptr;
+    errorMessage_.clear();
+    errorItems_ = 0;
+    recordCount_ = 0;
+    totalPages_ = 1;
+    success_ = false;
+    done_ = false;
+    error_ = false;
+}
+
+RecordListParser::Field RecordListParser::fieldForKey(const QByteArray &key)
+{
+    switch (key.size()) {
+    case 2:
+        return key == "id" ? Id : Other;
+    case 3:
+        return key == "ttl" ? Ttl : Other;
+    case 4:
+        return key == "name" ? Name : key == "type" ? Type : Other;
+    case 6:
+        return key == "result" ? Result : key == "errors" ? Errors : Other;
+    case 7:
+        return key == "success" ? Success : key == "content" ? Content : key == "message" ? Message : Other;
+    case 11:
+        return key == "result_info" ? ResultInfo : key == "total_pages" ? TotalPages : Other;
+    default:
+        return Other;
+    }
+}
+
+void RecordListParser::feed(const char *data, qsizetype size)
+{
+    for (qsizetype i = 0; i < size && !error_; ++i) {
+        const char c = data[i];
+
+        if (token_ == String) {
+            if (unicodeDigits_ > 0) {
+                const int value = hexValue(c);
+                if (value < 0) {
+                    fail();
+                    return;
+                }
+                unicode_ = (unicode_ << 4) | quint32(value);
+                if (--unicodeDigits_ == 0) {
+                    appendCodePoint(unicode_);
+                }
+            } else if (escape_) {
+                escape_ = false;
+                char decoded = 0;
+                switch (c) {
+                case '"': decoded = '"'; break;
+                case '\\': decoded = '\\'; break;
+                case '/': decoded = '/'; break;
+                case 'b': decoded = '\b'; break;
+                case 'f': decoded = '\f'; break;
+                case 'n': decoded = '\n'; break;
+                case 'r': decoded = '\r'; break;
+                case 't': decoded = '\t'; break;
+                case 'u':
+                    unicodeDigits_ = 4;
+                    unicode_ = 0;
+                    continue;
+                default:
+                    fail();
+                    return;
+                }
+                flushSurrogate();
+                if (target_) {
+                    target_->append(decoded);
+                }
+            } else if (c == '\\') {
+                escape_ = true;
+            } else if (c == '"') {
+                endString();
+            } else if (target_) {
+                flushSurrogate();
+                // 一次追加到下一个引号或转义符之前的全部内容
+                qsizetype end = i + 1;
+                while (end < size && data[end] != '"' && data[end] != '\\') {
+                    ++end;
+                }
+                target_->append(data + i, end - i);
+                i = end - 1;
+            }
+            continue;
+        }
+
+        if (token_ == Number || token_ == Literal) {
+            if (token_ == Number ? isNumberChar(c) : (c >= 'a' && c <= 'z')) {
+                scratch_.append(c);
+                continue;
+            }
+            // 数字或字面量结束，当前字符按普通字符继续处理
+            endScalar();
+            if (error_) {
+                return;
+            }
+        }
+
+        switch (c) {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            break;
+        case '{':
+            beginContainer(true);
+            break;
+        case '[':
+            beginContainer(false);
+            break;
+        case '}':
+            endContainer(true);
+            break;
+        case ']':
+            endContainer(false);
+            break;
+        case ',':
+            if (stack_.isEmpty()) {
+                fail();
+            } else if (stack_.last().isObject) {
+                stack_.last().expectKey = true;
+            }
+            break;
+        case ':':
+            if (stack_.isEmpty() || !stack_.last().isObject || stack_.last().expectKey) {
+                fail();
+            }
+            break;
+        case '"':
+            beginString();
+            break;
+        case 't':
+        case 'f':
+        case 'n':
+            if (stack_.isEmpty()) {
+                fail();
+                break;
+            }
+            token_ = Literal;
+            scratch_.resize(0);
+            scratch_.append(c);
+            break;
+        default:
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                if (stack_.isEmpty()) {
+                    fail();
+                    break;
+                }
+                token_ = Number;
+                scratch_.resize(0);
+                scratch_.append(c);
+            } else {
+                fail();
+            }
+            break;
+        }
+    }
+}
+
+bool RecordListParser::finish()
+{
+    if (token_ == Number || token_ == Literal) {
+        endScalar();
+    }
+    return !error_ && done_ && token_ == NoToken && stack_.isEmpty();
+}
+
+void RecordListParser::beginContainer(bool isObject)
+{
+    if (done_ || stack_.size() >= MAX_DEPTH) {
+        fail();
+        return;
+    }
+
+    Field field = Other;
+    if (stack_.isEmpty()) {
+        // 响应必须是一个对象
+        if (!isObject) {
+            fail();
+            return;
+        }
+    } else {
+        const Frame &top = stack_.last();
+        if (top.isObject && top.expectKey) {
+            fail();
+            return;
+        }
+        if (top.isObject && stack_.size() == 1) {
+            field = top.key;
+        } else if (!top.isObject && isObject && stack_.size() == 2) {
+            field = top.field == Result ? RecordItem : top.field == Errors ? ErrorItem : Other;
+        }
+    }
+
+    if (field == RecordItem) {
+        current_.id.resize(0);
+        current_.name.resize(0);
+        current_.type.resize(0);
+        current_.content.resize(0);
+        current_.ttl = 0;
+    } else if (field == ErrorItem) {
+        ++errorItems_;
+    }
+    stack_.append(Frame{isObject, field, Other, isObject});
+}
+
+void RecordListParser::endContainer(bool isObject)
+{
+    if (stack_.isEmpty() || stack_.last().isObject != isObject) {
+        fail();
+        return;
+    }
+
+    const Field field = stack_.last().field;
+    stack_.removeLast();
+    if (field == RecordItem) {
+        ++recordCount_;
+        if (handler_) {
+            handler_(current_);
+        }
+    }
+    if (stack_.isEmpty()) {
+        done_ = true;
+    }
+}
+
+QByteArray *RecordListParser::stringTarget()
+{
+    const Frame &top = stack_.last();
+    if (!top.isObject) {
+        return nullptr;
+    }
+
+    if (top.field == RecordItem) {
+        switch (top.key) {
+        case Id: return &current_.id;
+        case Name: return &current_.name;
+        case Type: return &current_.type;
+        case Content: return &current_.content;
+        default: return nullptr;
+        }
+    }
+    if (top.field == ErrorItem && top.key == Message && errorItems_ == 1) {
+        return &errorMessage_;
+    }
+    return nullptr;
+}
+
+void RecordListParser::beginString()
+{
+    if (stack_.isEmpty()) {
+        fail();
+        return;
+    }
+
+    Frame &top = stack_.last();
+    tokenIsKey_ = top.isObject && top.expectKey;
+    target_ = tokenIsKey_ ? &scratch_ : stringTarget();
+    if (target_) {
+        target_->resize(0);
+    }
+    token_ = String;
+}
+
+void RecordListParser::endString()
+{
+    token_ = NoToken;
+    flushSurrogate();
+    if (tokenIsKey_) {
+        Frame &top = stack_.last();
+        top.key = fieldForKey(scratch_);
+        top.expectKey = false;
+    }
+    target_ = nullptr;
+}
+
+void RecordListParser::endScalar()
+{
+    const Token token = token_;
+    token_ = NoToken;
+
+    const Frame &top = stack_.last();
+    if (top.isObject && top.expectKey) {
+        fail();
+        return;
+    }
+
+    if (token == Literal) {
+        const bool isTrue = scratch_ == "true";
+        if (!isTrue && scratch_ != "false" && scratch_ != "null") {
+            fail();
+            return;
+        }
+        if (stack_.size() == 1 && top.key == Success) {
+            success_ = isTrue;
+        }
+        return;
+    }
+
+    bool ok = false;
+    const int value = scratch_.toInt(&ok);
+    if (top.field == RecordItem && top.key == Ttl) {
+        current_.ttl = ok ? value : 0;
+    } else if (top.field == ResultInfo && top.key == TotalPages && ok) {
+        totalPages_ = qMax(1, value);
+    }
+}
+
+void RecordListParser::flushSurrogate()
+{
+    // 没有低位代理跟随的高位代理替换为 U+FFFD
+    if (highSurrogate_) {
+        highSurrogate_ = 0;
+        if (target_) {
+            target_->append("\xef\xbf\xbd");
+        }
+    }
+}
+
+void RecordListParser::appendCodePoint(quint32 codePoint)
+{
+    // 代理对合并为一个码位
+    if (codePoint >= 0xd800 && codePoint <= 0xdbff) {
+        highSurrogate_ = codePoint;
+        return;
+    }
+    if (codePoint >= 0xdc00 && codePoint <= 0xdfff) {
+        if (!highSurrogate_) {
+            codePoint = 0xfffd;
+        } else {
+            codePoint = 0x10000 + ((highSurrogate_ - 0xd800) << 10) + (codePoint - 0xdc00);
+        }
+    } else {
+        flushSurrogate();
+    }
+    highSurrogate_ = 0;
+
+    if (!target_) {
+        return;
+    }
+    if (codePoint < 0x80) {
+        target_->append(char(codePoint));
+    } else if (codePoint < 0x800) {
+        target_->append(char(0xc0 | (codePoint >> 6)));
+        target_->append(char(0x80 | (codePoint & 0x3f)));
+    } else if (codePoint < 0x10000) {
+        target_->append(char(0xe0 | (codePoint >> 12)));
+        target_->append(char(0x80 | ((codePoint >> 6) & 0x3f)));
+        target_->append(char(0x80 | (codePoint & 0x3f)));
+    } else {
+        target_->append(char(0xf0 | (codePoint >> 18)));
+        target_->append(char(0x80 | ((codePoint >> 12) & 0x3f)));
+        target_->append(char(0x80 | ((codePoint >> 6) & 0x3f)));
+        target_->append(char(0x80 | (codePoint & 0x3f)));
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef RECORDLISTPARSER_H
+#define RECORDLISTPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVarLengthArray>
+#include <functional>
+
+// Cloudflare 记录列表响应的流式解析器
+//
+// 数据可以按任意位置切分后逐段输入，不构建 JSON 文档；
+// 只提取每条记录的 id、name、type、content、ttl，以及顶层的 success、
+// 第一条错误信息和 result_info.total_pages，其余内容直接跳过。
+// 记录的各字段缓冲区在记录之间复用，稳定状态下不再分配内存。
+class RecordListParser
+{
+public:
+    struct Record
+    {
+        QByteArray id;
+        QByteArray name;
+        QByteArray type;
+        QByteArray content;
+        int ttl = 0;
+    };
+    // 每解析完一条记录调用一次，参数只在回调期间有效
+    using RecordHandler = std::function<void(const Record &)>;
+
+    void setRecordHandler(RecordHandler handler) { handler_ = std::move(handler); }
+
+    void feed(const char *data, qsizetype size);
+    void feed(const QByteArray &chunk) { feed(chunk.constData(), chunk.size()); }
+    // 输入结束，返回是否为一个完整的 JSON 对象
+    bool finish();
+    void reset();
+
+    bool hasError() const { return error_; }
+    bool success() const { return success_; }
+    QString firstError() const { return QString::fromUtf8(errorMessage_); }
+    int totalPages() const { return totalPages_; }
+    int recordCount() const { return recordCount_; }
+
+private:
+    enum Field : quint8 {
+        Other,
+        Success,
+        Result,
+        Errors,
+        ResultInfo,
+        Message,
+        TotalPages,
+        Id,
+        Name,
+        Type,
+        Content,
+        Ttl,
+        // result 和 errors 数组中的对象
+        RecordItem,
+        ErrorItem,
+    };
+
+    enum Token : quint8 {
+        NoToken,
+        String,
+        Number,
+        Literal,
+    };
+
+    struct Frame
+    {
+        bool isObject;
+        // 本容器在上一层中的含义
+        Field field;
+        // 对象中当前值的键
+        Field key;
+        bool expectKey;
+    };
+
+    static Field fieldForKey(const QByteArray &key);
+    QByteArray *stringTarget();
+    void beginContainer(bool isObject);
+    void endContainer(bool isObject);
+    void beginString();
+    void endString();
+    void endScalar();
+    void appendCodePoint(quint32 codePoint);
+    void flushSurrogate();
+    void fail() { error_ = true; }
+
+private:
+    RecordHandler handler_;
+    QVarLengthArray<Frame, 8> stack_;
+
+    Token token_ = NoToken;
+    bool tokenIsKey_ = false;
+    bool escape_ = false;
+    int unicodeDigits_ = 0;
+    quint32 unicode_ = 0;
+    quint32 highSurrogate_ = 0;
+    // 当前字符串写入的位置，为空时跳过内容
+    QByteArray *target_ = nullptr;
+    // 键、数字和字面量的缓冲区
+    QByteArray scratch_;
+
+    Record current_;
+    QByteArray errorMessage_;
+    int errorItems_ = 0;
+    int recordCount_ = 0;
+    int totalPages_ = 1;
+    bool success_ = false;
+    bool done_ = false;
+    bool error_ = false;
+};
+
+#endif // RECORDLISTPARSER_H
@@ -0,0 +1,233 @@
+#include "recordtable.h"
+
+#include <QHostAddress>
+#include <cstring>
+
+quint32 StringPool::intern(const QString &value)
+{
+    auto it = ids_.constFind(value);
+    if (it != ids_.constEnd()) {
+        return it.value();
+    }
+    const quint32 id = quint32(strings_.size());
+    strings_.append(value);
+    ids_.insert(value, id);
+    return id;
+}
+
+void StringPool::clear()
+{
+    strings_.clear();
+    ids_.clear();
+}
+
+void RecordTable::reserve(int rows)
+{
+    names_.reserve(rows);
+    zones_.reserve(rows);
+    types_.reserve(rows);
+    flags_.reserve(rows);
+    ttls_.reserve(rows);
+    ids_.reserve(rows);
+    contents_.reserve(rows);
+    index_.reserve(rows);
+}
+
+void RecordTable::clear()
+{
+    strings_.clear();
+    names_.clear();
+    zones_.clear();
+    types_.clear();
+    flags_.clear();
+    ttls_.clear();
+    ids_.clear();
+    contents_.clear();
+    index_.clear();
+}
+
+int RecordTable::upsert(const QString &zone, const QString &type, const QString &name)
+{
+    const quint8 code = typeCode(type);
+    const quint32 nameId = strings_.intern(name);
+    const quint64 key = indexKey(code, nameId);
+
+    auto it = index_.constFind(key);
+    if (it != index_.constEnd()) {
+        return it.value();
+    }
+
+    const int row = size();
+    names_.append(nameId);
+    zones_.append(strings_.intern(zone));
+    types_.append(code);
+    flags_.append(0);
+    ttls_.append(0);
+    ids_.append(Bytes16{});
+    contents_.append(Bytes16{});
+    index_.insert(key, row);
+    return row;
+}
+
+int RecordTable::find(const QString &type, const QString &name) const
+{
+    const quint32 nameId = strings_.find(name);
+    if (nameId == StringPool::NoId) {
+        return NoRow;
+    }
+    return index_.value(indexKey(typeCode(type), nameId), NoRow);
+}
+
+bool RecordTable::parseHexId(const QString &text, Bytes16 &id)
+{
+    if (text.size() != 32) {
+        return false;
+    }
+    for (int i = 0; i < 32; ++i) {
+        const ushort c = text.at(i).unicode();
+        int nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else {
+            // 大写字母无法原样还原，交给驻留池
+            return false;
+        }
+        if (i % 2 == 0) {
+            id[i / 2] = quint8(nibble << 4);
+        } else {
+            id[i / 2] |= quint8(nibble);
+        }
+    }
+    return true;
+}
+
+void RecordTable::setRecordId(int row, const QString &id)
+{
+    if (id.isEmpty()) {
+        clearRecordId(row);
+        return;
+    }
+
+    Bytes16 &slot = ids_[row];
+    if (parseHexId(id, slot)) {
+        flags_[row] = quint8((flags_.at(row) | HasId) & ~IdInterned);
+        return;
+    }
+
+    // 其他格式的ID（模拟服务商等）保存驻留池中的编号
+    const quint32 interned = strings_.intern(id);
+    slot.fill(0);
+    std::memcpy(slot.data(), &interned, sizeof(interned));
+    flags_[row] |= quint8(HasId | IdInterned);
+}
+
+QString RecordTable::recordId(int row) const
+{
+    const quint8 flags = flags_.at(row);
+    if (!(flags & HasId)) {
+        return QString();
+    }
+
+    const Bytes16 &slot = ids_.at(row);
+    if (flags & IdInterned) {
+        quint32 interned;
+        std::memcpy(&interned, slot.data(), sizeof(interned));
+        return strings_.at(interned);
+    }
+
+    static const char digits[] = "0123456789abcdef";
+    QString id(32, Qt::Uninitialized);
+    for (int i = 0; i < 16; ++i) {
+        id[i * 2] = QLatin1Char(digits[slot[i] >> 4]);
+        id[i * 2 + 1] = QLatin1Char(digits[slot[i] & 0x0f]);
+    }
+    return id;
+}
+
+bool RecordTable::parseAddress(const QString &text, Bytes16 &address)
+{
+    QHostAddress parsed;
+    if (!parsed.setAddress(text)) {
+        return false;
+    }
+
+    if (parsed.protocol() == QAbstractSocket::IPv4Protocol) {
+        // ::ffff:a.b.c.d
+        const quint32 ipv4 = parsed.toIPv4Address();
+        address.fill(0);
+        address[10] = 0xff;
+        address[11] = 0xff;
+        address[12] = quint8(ipv4 >> 24);
+        address[13] = quint8(ipv4 >> 16);
+        address[14] = quint8(ipv4 >> 8);
+        address[15] = quint8(ipv4);
+        return true;
+    }
+
+    const Q_IPV6ADDR ipv6 = parsed.toIPv6Address();
+    std::memcpy(address.data(), ipv6.c, 16);
+    return true;
+}
+
+bool RecordTable::setContent(int row, const QString &content)
+{
+    if (!parseAddress(content, contents_[row])) {
+        flags_[row] &= quint8(~HasContent);
+        return false;
+    }
+    flags_[row] |= HasContent;
+    return true;
+}
+
+QString RecordTable::content(int row) const
+{
+    if (!hasContent(row)) {
+        return QString();
+    }
+
+    const Bytes16 &address = contents_.at(row);
+    if (types_.at(row) == 4) {
+        return QHostAddress(quint32(address[12]) << 24 | quint32(address[13]) << 16
+                            | quint32(address[14]) << 8 | quint32(address[15])).toString();
+    }
+    return QHostAddress(address.data()).toString();
+}
+
+bool RecordTable::contentEquals(int row, const QString &content) const
+{
+    Bytes16 address;
+    return hasContent(row) && parseAddress(content, address) && address == contents_.at(row);
+}
+
+void RecordTable::resetSeen()
+{
+    for (quint8 &flags : flags_) {
+        flags &= quint8(~(Seen | Duplicate));
+    }
+}
+
+bool RecordTable::markSeen(int row)
+{
+    if (flags_.at(row) & Seen) {
+        flags_[row] |= Duplicate;
+        return false;
+    }
+    flags_[row] |= Seen;
+    return true;
+}
+
+qint64 RecordTable::memoryUsage() const
+{
+    // 列按容量计算；QHash 每个节点约为键值大小加上桶指针
+    const qint64 columns = names_.capacity() * qint64(sizeof(quint32))
+                           + zones_.capacity() * qint64(sizeof(quint32))
+                           + types_.capacity() * qint64(sizeof(quint8))
+                           + flags_.capacity() * qint64(sizeof(quint8))
+                           + ttls_.capacity() * qint64(sizeof(quint32))
+                           + ids_.capacity() * qint64(sizeof(Bytes16))
+                           + contents_.capacity() * qint64(sizeof(Bytes16));
+    const qint64 index = index_.capacity() * qint64(sizeof(quint64) + sizeof(int) + sizeof(void *));
+    return columns + index;
+}
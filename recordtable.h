@@ -0,0 +1,107 @@
+#ifndef RECORDTABLE_H
+#define RECORDTABLE_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <array>
+
+// 字符串驻留池：相同的记录名和区域ID只保存一份
+class StringPool
+{
+public:
+    static constexpr quint32 NoId = 0xffffffff;
+
+    quint32 intern(const QString &value);
+    // 未驻留时返回 NoId
+    quint32 find(const QString &value) const { return ids_.value(value, NoId); }
+    const QString &at(quint32 id) const { return strings_.at(id); }
+    int size() const { return int(strings_.size()); }
+    void clear();
+
+private:
+    QList<QString> strings_;
+    QHash<QString, quint32> ids_;
+};
+
+// 按列存放的记录表，替代每条记录一个 QJsonObject 的做法
+//
+// 名称和区域ID驻留为整数，地址和 Cloudflare 记录ID以定长二进制保存，
+// 状态打包为一个字节；JSON 只在收发请求时生成和解析。
+class RecordTable
+{
+public:
+    static constexpr int NoRow = -1;
+
+    enum Flag : quint8 {
+        HasId = 0x01,
+        HasContent = 0x02,
+        // 本轮查询结果中出现过
+        Seen = 0x04,
+        // 本轮查询结果中出现了多次
+        Duplicate = 0x08,
+        // 记录ID不是 32 位十六进制，保存在驻留池中
+        IdInterned = 0x10,
+    };
+
+    void reserve(int rows);
+    void clear();
+    int size() const { return int(names_.size()); }
+
+    // 查找记录，不存在时新增一行
+    int upsert(const QString &zone, const QString &type, const QString &name);
+    int find(const QString &type, const QString &name) const;
+
+    QString zone(int row) const { return strings_.at(zones_.at(row)); }
+    QString type(int row) const { return types_.at(row) == 6 ? QStringLiteral("AAAA") : QStringLiteral("A"); }
+    QString name(int row) const { return strings_.at(names_.at(row)); }
+
+    void setRecordId(int row, const QString &id);
+    void clearRecordId(int row) { flags_[row] &= quint8(~(HasId | IdInterned)); }
+    bool hasRecordId(int row) const { return flags_.at(row) & HasId; }
+    QString recordId(int row) const;
+
+    // 内容为地址时保存 16 字节二进制（IPv4 使用映射形式），无法解析时返回 false
+    bool setContent(int row, const QString &content);
+    bool hasContent(int row) const { return flags_.at(row) & HasContent; }
+    QString content(int row) const;
+    bool contentEquals(int row, const QString &content) const;
+
+    quint32 ttl(int row) const { return ttls_.at(row); }
+    void setTtl(int row, quint32 ttl) { ttls_[row] = ttl; }
+
+    // 每轮查询前清除查询结果标记
+    void resetSeen();
+    // 记录在查询结果中出现一次，重复出现时返回 false
+    bool markSeen(int row);
+    bool isSeen(int row) const { return flags_.at(row) & Seen; }
+    bool isDuplicate(int row) const { return flags_.at(row) & Duplicate; }
+
+    // 各列和索引占用的字节数，不含驻留的字符串
+    qint64 memoryUsage() const;
+    const StringPool &strings() const { return strings_; }
+
+private:
+    using Bytes16 = std::array<quint8, 16>;
+
+    static quint8 typeCode(const QString &type) { return type == QLatin1String("AAAA") ? 6 : 4; }
+    static quint64 indexKey(quint8 type, quint32 name) { return (quint64(type) << 32) | name; }
+    static bool parseAddress(const QString &text, Bytes16 &address);
+    static bool parseHexId(const QString &text, Bytes16 &id);
+
+private:
+    StringPool strings_;
+
+    QList<quint32> names_;
+    QList<quint32> zones_;
+    QList<quint8> types_;
+    QList<quint8> flags_;
+    QList<quint32> ttls_;
+    QList<Bytes16> ids_;
+    QList<Bytes16> contents_;
+
+    // (类型, 名称) -> 行号
+    QHash<quint64, int> index_;
+};
+
+#endif // RECORDTABLE_H
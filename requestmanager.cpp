@@ -0,0 +1,230 @@
+#include "requestmanager.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+
+ManagedReply::ManagedReply(RequestManager *manager, const QUrl &url)
+    : QObject(manager)
+    , manager_(manager)
+    , url_(url)
+{
+}
+
+void ManagedReply::abort()
+{
+    if (!running_) {
+        return;
+    }
+    manager_->detach(this);
+    complete(QNetworkReply::OperationCanceledError, "Operation canceled", 0, QByteArray());
+}
+
+void ManagedReply::complete(QNetworkReply::NetworkError error, const QString &errorString,
+                            int httpStatus, const QByteArray &body)
+{
+    running_ = false;
+    error_ = error;
+    errorString_ = errorString;
+    httpStatus_ = httpStatus;
+    body_ = body;
+
+    if (error != QNetworkReply::NoError) {
+        emit errorOccurred(error);
+    }
+    emit finished();
+    deleteLater();
+}
+
+RequestManager::RequestManager(QNetworkAccessManager *networkManager, QObject *parent)
+    : QObject(parent)
+    , networkManager_(networkManager)
+{
+}
+
+RequestManager::~RequestManager()
+{
+    qDeleteAll(flights_);
+}
+
+QString RequestManager::flightKey(const QByteArray &verb, const QNetworkRequest &request)
+{
+    // 请求头（包括认证信息）不同的请求结果可能不同，不能合并
+    QByteArray headerBlock;
+    const QList<QByteArray> headers = request.rawHeaderList();
+    for (const QByteArray &header : headers) {
+        headerBlock += header + ": " + request.rawHeader(header) + "\n";
+    }
+    const QByteArray digest = QCryptographicHash::hash(headerBlock, QCryptographicHash::Sha1).toHex();
+    return QString("%1 %2 %3").arg(QString::fromLatin1(verb),
+                                   request.url().toString(QUrl::FullyEncoded),
+                                   QString::fromLatin1(digest));
+}
+
+ManagedReply *RequestManager::get(const QNetworkRequest &request)
+{
+    const QString key = flightKey("GET", request);
+    if (Flight *flight = shared_.value(key)) {
+        ++coalesced_;
+        qDebug() << "join in-flight request:" << request.url().toString(QUrl::RemoveQuery);
+        return attach(flight);
+    }
+
+    ManagedReply *reply = start(networkManager_->get(request), key);
+    shared_.insert(key, flights_.value(reply->source_));
+    return reply;
+}
+
+ManagedReply *RequestManager::getStreamed(const QNetworkRequest &request)
+{
+    QNetworkReply *networkReply = networkManager_->get(request);
+    ManagedReply *reply = start(networkReply, QString());
+    flights_.value(networkReply)->streaming = true;
+    reply->streaming_ = true;
+
+    connect(networkReply, &QNetworkReply::readyRead, this, [this, networkReply]() {
+        onReadyRead(networkReply);
+    });
+    return reply;
+}
+
+ManagedReply *RequestManager::post(const QNetworkRequest &request, const QByteArray &data)
+{
+    return start(networkManager_->post(request, data), QString());
+}
+
+ManagedReply *RequestManager::put(const QNetworkRequest &request, const QByteArray &data)
+{
+    return start(networkManager_->put(request, data), QString());
+}
+
+ManagedReply *RequestManager::deleteResource(const QNetworkRequest &request)
+{
+    return start(networkManager_->deleteResource(request), QString());
+}
+
+ManagedReply *RequestManager::failed(const QUrl &url, QNetworkReply::NetworkError error,
+                                     const QString &errorString)
+{
+    // 与真实请求一样异步结束，调用方可以先连接信号；没有底层请求，abort() 只结束句柄
+    ManagedReply *reply = new ManagedReply(this, url);
+    QMetaObject::invokeMethod(reply, [reply, error, errorString]() {
+        if (reply->isRunning()) {
+            reply->complete(error, errorString, 0, QByteArray());
+        }
+    }, Qt::QueuedConnection);
+    return reply;
+}
+
+ManagedReply *RequestManager::start(QNetworkReply *reply, const QString &key)
+{
+    Flight *flight = new Flight;
+    flight->reply = reply;
+    flight->key = key;
+    flight->host = reply->url().host();
+    flights_.insert(reply, flight);
+
+    reply->setParent(this);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        onFinished(reply);
+    });
+
+    updateHost(flight->host, 1);
+    return attach(flight);
+}
+
+ManagedReply *RequestManager::attach(Flight *flight)
+{
+    ManagedReply *waiter = new ManagedReply(this, flight->reply->url());
+    waiter->source_ = flight->reply;
+    flight->waiters.append(QPointer<ManagedReply>(waiter));
+    return waiter;
+}
+
+void RequestManager::detach(ManagedReply *waiter)
+{
+    Flight *flight = flights_.value(waiter->source_);
+    if (!flight) {
+        return;
+    }
+
+    flight->waiters.removeAll(QPointer<ManagedReply>(waiter));
+    flight->waiters.removeAll(QPointer<ManagedReply>());
+    if (!flight->waiters.isEmpty()) {
+        return;
+    }
+
+    // 没有调用方等待时中止底层请求，abort() 会同步触发 onFinished 完成清理
+    if (shared_.value(flight->key) == flight) {
+        shared_.remove(flight->key);
+    }
+    flight->reply->abort();
+}
+
+void RequestManager::onFinished(QNetworkReply *reply)
+{
+    Flight *flight = flights_.take(reply);
+    if (!flight) {
+        return;
+    }
+    if (!flight->key.isEmpty() && shared_.value(flight->key) == flight) {
+        shared_.remove(flight->key);
+    }
+    updateHost(flight->host, -1);
+    reply->deleteLater();
+
+    const QNetworkReply::NetworkError error = reply->error();
+    const QString errorString = reply->errorString();
+    const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QByteArray body = reply->readAll();
+
+    // 流式请求把剩余数据作为最后一段交付
+    if (flight->streaming) {
+        for (const QPointer<ManagedReply> &waiter : std::as_const(flight->waiters)) {
+            if (waiter && waiter->isRunning() && !body.isEmpty()) {
+                emit waiter->dataReceived(body);
+            }
+        }
+        body.clear();
+    }
+
+    // 回调中可能发起新的相同请求，此时本次请求已从共享表移除
+    const bool shared = flight->waiters.size() > 1;
+    for (const QPointer<ManagedReply> &waiter : std::as_const(flight->waiters)) {
+        if (waiter && waiter->isRunning()) {
+            waiter->shared_ = shared;
+            waiter->complete(error, errorString, httpStatus, body);
+        }
+    }
+    delete flight;
+}
+
+void RequestManager::onReadyRead(QNetworkReply *reply)
+{
+    Flight *flight = flights_.value(reply);
+    if (!flight || !flight->streaming) {
+        return;
+    }
+
+    const QByteArray chunk = reply->readAll();
+    if (chunk.isEmpty()) {
+        return;
+    }
+    // 回调中可能中止请求并释放 flight，先复制等待列表
+    const QList<QPointer<ManagedReply>> waiters = flight->waiters;
+    for (const QPointer<ManagedReply> &waiter : waiters) {
+        if (waiter && waiter->isRunning()) {
+            emit waiter->dataReceived(chunk);
+        }
+    }
+}
+
+void RequestManager::updateHost(const QString &host, int delta)
+{
+    int &count = hostCounts_[host];
+    count += delta;
+    const int current = count;
+    if (current <= 0) {
+        hostCounts_.remove(host);
+    }
+    emit hostLoadChanged(host, qMax(0, current));
+}
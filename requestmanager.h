@@ -0,0 +1,123 @@
+#ifndef REQUESTMANAGER_H
+#define REQUESTMANAGER_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QUrl>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+class RequestManager;
+
+// 调用方持有的请求句柄，用法与 QNetworkReply 相同
+//
+// 多个相同的 GET 共享一个底层请求，每个调用方各自持有一个句柄；
+// 句柄在发出 finished 后由 RequestManager 统一释放。
+class ManagedReply : public QObject
+{
+    Q_OBJECT
+public:
+    QUrl url() const { return url_; }
+    bool isRunning() const { return running_; }
+    QNetworkReply::NetworkError error() const { return error_; }
+    QString errorString() const { return errorString_; }
+    int httpStatus() const { return httpStatus_; }
+    // 流式请求的响应体通过 dataReceived 交付，readAll() 为空
+    QByteArray readAll() const { return body_; }
+    bool isStreaming() const { return streaming_; }
+    // 结果是否与其他调用方共享同一个请求
+    bool isShared() const { return shared_; }
+
+    // 只取消本句柄；共享请求在所有调用方都取消后才真正中止
+    void abort();
+
+signals:
+    void errorOccurred(QNetworkReply::NetworkError error);
+    // 流式请求收到的一段数据，全部数据在 finished 之前交付完毕
+    void dataReceived(const QByteArray &chunk);
+    void finished();
+
+private:
+    friend class RequestManager;
+    ManagedReply(RequestManager *manager, const QUrl &url);
+
+    void complete(QNetworkReply::NetworkError error, const QString &errorString,
+                  int httpStatus, const QByteArray &body);
+
+private:
+    RequestManager *manager_;
+    // 承载本句柄的底层请求
+    QNetworkReply *source_ = nullptr;
+    QUrl url_;
+    bool running_ = true;
+    bool shared_ = false;
+    bool streaming_ = false;
+    QNetworkReply::NetworkError error_ = QNetworkReply::NoError;
+    QString errorString_;
+    int httpStatus_ = 0;
+    QByteArray body_;
+};
+
+// 集中管理所有 HTTP 请求：跟踪进行中的请求、合并相同的幂等请求、统一管理生命周期
+class RequestManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RequestManager(QNetworkAccessManager *networkManager, QObject *parent = nullptr);
+    ~RequestManager() override;
+
+    // 相同地址和请求头的 GET 已在进行时直接共享其结果
+    ManagedReply *get(const QNetworkRequest &request);
+    // 响应体边收边交付，不在内存中缓存完整内容；不与其他请求合并
+    ManagedReply *getStreamed(const QNetworkRequest &request);
+    ManagedReply *post(const QNetworkRequest &request, const QByteArray &data);
+    ManagedReply *put(const QNetworkRequest &request, const QByteArray &data);
+    ManagedReply *deleteResource(const QNetworkRequest &request);
+    // 不发出网络请求，返回一个在事件循环下一轮以给定错误结束的句柄
+    ManagedReply *failed(const QUrl &url, QNetworkReply::NetworkError error, const QString &errorString);
+
+    int inFlightCount() const { return flights_.size(); }
+    int inFlightCount(const QString &host) const { return hostCounts_.value(host); }
+    QHash<QString, int> inFlightByHost() const { return hostCounts_; }
+    // 因合并而省掉的请求数
+    quint64 coalescedCount() const { return coalesced_; }
+
+    QNetworkAccessManager *networkManager() const { return networkManager_; }
+
+signals:
+    void hostLoadChanged(const QString &host, int inFlight);
+
+private:
+    struct Flight {
+        QNetworkReply *reply = nullptr;
+        QString key;
+        QString host;
+        bool streaming = false;
+        QList<QPointer<ManagedReply>> waiters;
+    };
+
+    static QString flightKey(const QByteArray &verb, const QNetworkRequest &request);
+    ManagedReply *attach(Flight *flight);
+    ManagedReply *start(QNetworkReply *reply, const QString &key);
+    void onFinished(QNetworkReply *reply);
+    void onReadyRead(QNetworkReply *reply);
+    void detach(ManagedReply *waiter);
+    void updateHost(const QString &host, int delta);
+
+private:
+    friend class ManagedReply;
+
+    QNetworkAccessManager *networkManager_;
+    QHash<QNetworkReply *, Flight *> flights_;
+    // 可共享的请求，按请求键索引
+    QHash<QString, Flight *> shared_;
+    QHash<QString, int> hostCounts_;
+    quint64 coalesced_ = 0;
+};
+
+#endif // REQUESTMANAGER_H
@@ -0,0 +1,337 @@
+#include "simulator.h"
+#include "config.h"
+#include "clock.h"
+#include "timerwheel.h"
+#include "mockprovider.h"
+#include "journal.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QFile>
+#include <QDir>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QDebug>
+
+#include <algorithm>
+
+// 按轨迹返回当前地址的地址来源，不访问网络
+class TraceDiscovery : public IpDiscovery
+{
+public:
+    TraceDiscovery(const QString &ipv4, const QString &ipv6, const bool &online, quint64 &calls)
+        : IpDiscovery(nullptr), ipv4_(ipv4), ipv6_(ipv6), online_(online), calls_(calls) {}
+
+    void discover(int timeout = 30000) override
+    {
+        Q_UNUSED(timeout);
+        if (running_) {
+            return;
+        }
+        running_ = true;
+        calls_ += 2;
+
+        // 模拟查询耗时
+        TimerWheel::getInstance().schedule(100, this, [this]() {
+            running_ = false;
+            report(true, ipv4_);
+            report(false, ipv6_);
+            emit finished();
+        });
+    }
+
+private:
+    void report(bool isIpv4, const QString &address)
+    {
+        const QString family = isIpv4 ? "IPv4" : "IPv6";
+        if (!online_) {
+            emit failed(isIpv4, QString("Failed to get %1").arg(family));
+        } else if (address.isEmpty()) {
+            emit failed(isIpv4, QString("No public %1").arg(family));
+        } else {
+            emit discovered(isIpv4, address);
+        }
+    }
+
+private:
+    const QString &ipv4_;
+    const QString &ipv6_;
+    const bool &online_;
+    quint64 &calls_;
+    bool running_ = false;
+};
+
+Simulator::Simulator(const QString &tracePath, qint64 duration, QObject *parent)
+    : QObject(parent)
+    , tracePath_(tracePath)
+    , duration_(duration)
+    , networkManager_(new QNetworkAccessManager(this))
+{
+}
+
+qint64 Simulator::parseDuration(const QString &text)
+{
+    static const QRegularExpression part("(\\d+(?:\\.\\d+)?)([smhd]?)");
+    const QString value = text.trimmed().toLower();
+    if (value.isEmpty()) {
+        return -1;
+    }
+
+    // 支持 1d12h 这样的组合
+    qint64 total = 0;
+    int consumed = 0;
+    QRegularExpressionMatchIterator it = part.globalMatch(value);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        if (match.capturedStart() != consumed) {
+            return -1;
+        }
+        consumed = match.capturedEnd();
+
+        const QString unit = match.captured(2);
+        double scale = 1000;
+        if (unit == "m") {
+            scale = 60 * 1000;
+        } else if (unit == "h") {
+            scale = 3600 * 1000;
+        } else if (unit == "d") {
+            scale = 86400 * 1000;
+        }
+        total += qint64(match.captured(1).toDouble() * scale);
+    }
+    return consumed == value.size() ? total : -1;
+}
+
+bool Simulator::loadTrace(QString &error)
+{
+    QFile file(tracePath_);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        error = QString("Could not open trace file: %1").arg(file.errorString());
+        return false;
+    }
+
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        ++lineNumber;
+        const QString line = QString::fromUtf8(file.readLine()).section('#', 0, 0).trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        const QStringList parts = line.split(QRegularExpression("\\s+"));
+        Event event;
+        event.time = parseDuration(parts.value(0));
+        event.kind = parts.value(1).toLower();
+        event.address = parts.value(2);
+
+        const bool isAddress = (event.kind == "ipv4" || event.kind == "ipv6") && parts.size() == 3;
+        const bool isLink = (event.kind == "offline" || event.kind == "online") && parts.size() == 2;
+        if (event.time < 0 || (!isAddress && !isLink)) {
+            error = QString("Invalid trace line %1: %2").arg(lineNumber).arg(line);
+            return false;
+        }
+        events_.append(event);
+    }
+
+    std::stable_sort(events_.begin(), events_.end(), [](const Event &a, const Event &b) {
+        return a.time < b.time;
+    });
+
+    // 未指定时长时模拟到最后一个事件之后一天
+    if (duration_ <= 0) {
+        duration_ = (events_.isEmpty() ? 0 : events_.last().time) + 86400 * 1000;
+    }
+    return true;
+}
+
+void Simulator::updateStale(Family &family)
+{
+    const qint64 now = Clock::elapsed();
+    if (family.staleSince >= 0) {
+        family.staleTotal += now - family.staleSince;
+    }
+    family.staleSince = (!family.actual.isEmpty() && family.actual != family.published) ? now : -1;
+}
+
+void Simulator::apply(const Event &event)
+{
+    if (event.kind == "offline" || event.kind == "online") {
+        online_ = event.kind == "online";
+        service_->reachability()->setOnline(online_);
+        return;
+    }
+
+    Family &family = event.kind == "ipv4" ? ipv4_ : ipv6_;
+    if (family.actual == event.address) {
+        return;
+    }
+
+    // 上一次变化还没发布就又变了
+    if (family.changedAt >= 0) {
+        family.superseded++;
+    }
+    family.actual = event.address;
+    family.changedAt = Clock::elapsed();
+    family.changes++;
+    if (family.firstSeen < 0) {
+        family.firstSeen = family.changedAt;
+    }
+    updateStale(family);
+}
+
+void Simulator::onPublished(const DnsRecord &record)
+{
+    const bool isIpv4 = record.type == "A";
+    if (record.name != service_->recordName(isIpv4)) {
+        return;
+    }
+
+    Family &family = isIpv4 ? ipv4_ : ipv6_;
+    family.published = record.content;
+    if (family.changedAt >= 0 && record.content == family.actual) {
+        lags_.append(Clock::elapsed() - family.changedAt);
+        family.changedAt = -1;
+    }
+    updateStale(family);
+}
+
+int Simulator::run()
+{
+    QString error;
+    if (!loadTrace(error)) {
+        qCritical() << error;
+        return 1;
+    }
+
+    // 使用用户配置中的调度参数，服务商替换为本地模拟
+    Config &config = Config::getInstance();
+    config.init();
+    QJsonObject settings = config.getConfig();
+    settings[KEY_TARGET_PROVIDERS] = QJsonArray({"Mock"});
+    QJsonObject providers = settings["providers"].toObject();
+    if (!providers.contains("Mock")) {
+        providers["Mock"] = QJsonObject({{"latency", 200}});
+    }
+    settings["providers"] = providers;
+    if (settings["ipv4_record"].toString().isEmpty()) {
+        settings["ipv4_record"] = "home";
+    }
+    if (settings["ipv6_record"].toString().isEmpty()) {
+        settings["ipv6_record"] = "home";
+    }
+    // 虚拟时间下不能与真实运行的实例共享状态
+    settings[KEY_HOST_COORDINATION] = false;
+    config.setConfig(settings);
+
+    // 状态文件写到测试目录，不影响真实的缓存和待发送队列
+    QStandardPaths::setTestModeEnabled(true);
+    const QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QFile::remove(dataPath + "/pending.json");
+    QFile::remove(dataPath + "/state.json");
+    QDir(Journal::defaultDirectory()).removeRecursively();
+
+    Clock::setVirtual(0);
+    TimerWheel &wheel = TimerWheel::getInstance();
+
+    service_ = new DdnsService(networkManager_, this);
+    service_->openJournal();
+    service_->setDiscovery(new TraceDiscovery(ipv4_.actual, ipv6_.actual, online_, discoveryCalls_));
+    service_->reachability()->setOnline(true);
+    service_->reloadConfig();
+    connect(service_->dispatcher(), &UpdateDispatcher::cycleStarted, this, [this]() {
+        if (auto *mock = qobject_cast<MockProvider *>(service_->provider("Mock"))) {
+            connect(mock, &MockProvider::recordPublished, this, &Simulator::onPublished, Qt::UniqueConnection);
+        }
+    });
+
+    QElapsedTimer wall;
+    wall.start();
+
+    int next = 0;
+    auto applyDue = [this, &next]() {
+        while (next < events_.size() && events_[next].time <= Clock::elapsed()) {
+            apply(events_[next++]);
+        }
+    };
+
+    applyDue();
+    service_->startPolling(300000);
+    service_->start();
+
+    // 直接跳到下一个定时任务或轨迹事件，中间没有任何等待
+    while (true) {
+        QCoreApplication::processEvents();
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+
+        qint64 target = duration_;
+        const qint64 wake = wheel.nextDeadline();
+        if (wake >= 0) {
+            target = qMin(target, wake);
+        }
+        if (next < events_.size()) {
+            target = qMin(target, events_[next].time);
+        }
+
+        Clock::setVirtualTime(target);
+        applyDue();
+        wheel.poll();
+
+        if (Clock::elapsed() >= duration_) {
+            break;
+        }
+    }
+
+    updateStale(ipv4_);
+    updateStale(ipv6_);
+    service_->stop();
+    report(wall.elapsed());
+    return 0;
+}
+
+void Simulator::report(qint64 wallTime) const
+{
+    QTextStream out(stdout);
+    auto seconds = [](qint64 msec) { return QString::number(msec / 1000.0, 'f', 1) + "s"; };
+
+    MockProvider *mock = qobject_cast<MockProvider *>(service_->provider("Mock"));
+    const quint64 searches = mock ? mock->searchCalls() : 0;
+    const quint64 writes = mock ? mock->writeCalls() : 0;
+
+    out << QString("simulated %1 in %2 ms\n").arg(seconds(duration_)).arg(wallTime);
+    out << QString("address changes: %1 (ipv4 %2, ipv6 %3), superseded before publish: %4\n")
+               .arg(ipv4_.changes + ipv6_.changes)
+               .arg(ipv4_.changes)
+               .arg(ipv6_.changes)
+               .arg(ipv4_.superseded + ipv6_.superseded);
+    out << QString("api calls: %1 (search %2, write %3), discovery queries: %4\n")
+               .arg(searches + writes)
+               .arg(searches)
+               .arg(writes)
+               .arg(discoveryCalls_);
+
+    QList<qint64> lags = lags_;
+    std::sort(lags.begin(), lags.end());
+    auto percentile = [&lags](double q) {
+        return lags.isEmpty() ? 0 : lags.at(qMin<qsizetype>(lags.size() - 1, qsizetype(q * lags.size())));
+    };
+    out << QString("detection lag: p50 %1, p90 %2, p99 %3, max %4 (%5 published)\n")
+               .arg(seconds(percentile(0.5)))
+               .arg(seconds(percentile(0.9)))
+               .arg(seconds(percentile(0.99)))
+               .arg(seconds(lags.isEmpty() ? 0 : lags.last()))
+               .arg(lags.size());
+
+    for (const Family *family : {&ipv4_, &ipv6_}) {
+        if (family->firstSeen < 0) {
+            continue;
+        }
+        const qint64 span = qMax<qint64>(1, duration_ - family->firstSeen);
+        out << QString("stale %1 record: %2 (%3% of time)\n")
+                   .arg(family == &ipv4_ ? "A" : "AAAA")
+                   .arg(seconds(family->staleTotal))
+                   .arg(QString::number(100.0 * family->staleTotal / span, 'f', 3));
+    }
+    out << QString("scheduler wakeups: %1\n").arg(TimerWheel::getInstance().wakeups());
+}
@@ -0,0 +1,69 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QNetworkAccessManager>
+
+#include "ddnsservice.h"
+
+// 时间压缩模拟：虚拟时钟驱动真实的更新流程，按轨迹文件回放地址变化，
+// 写入本地模拟服务商，统计 API 调用数、检测延迟分布和记录过期时长
+//
+// 轨迹文件每行一个事件，时间为相对开始的偏移，可带 s/m/h/d 后缀：
+//   0    ipv4 203.0.113.10
+//   6h   ipv6 2001:db8:1::10
+//   2d   offline
+//   2d1h online
+class Simulator : public QObject
+{
+    Q_OBJECT
+public:
+    Simulator(const QString &tracePath, qint64 duration, QObject *parent = nullptr);
+
+    int run();
+
+    // 解析 90、15m、2h、3d 这样的时长，单位毫秒，无效时返回 -1
+    static qint64 parseDuration(const QString &text);
+
+private:
+    struct Event {
+        qint64 time = 0;
+        QString kind;
+        QString address;
+    };
+
+    // 每个地址族的真实地址与服务商上已发布地址
+    struct Family {
+        QString actual;
+        qint64 changedAt = -1;
+        QString published;
+        qint64 staleSince = -1;
+        qint64 staleTotal = 0;
+        qint64 firstSeen = -1;
+        int changes = 0;
+        int superseded = 0;
+    };
+
+    bool loadTrace(QString &error);
+    void apply(const Event &event);
+    void onPublished(const DnsRecord &record);
+    void updateStale(Family &family);
+    void report(qint64 wallTime) const;
+
+private:
+    QString tracePath_;
+    qint64 duration_;
+    QList<Event> events_;
+
+    QNetworkAccessManager *networkManager_;
+    DdnsService *service_ = nullptr;
+    Family ipv4_;
+    Family ipv6_;
+    bool online_ = true;
+    QList<qint64> lags_;
+    quint64 discoveryCalls_ = 0;
+};
+
+#endif // SIMULATOR_H
@@ -0,0 +1,299 @@
+#include "soak.h"
+#include "config.h"
+#include "timerwheel.h"
+
+#include <QStandardPaths>
+#include <QNetworkReply>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDir>
+#include <QTimer>
+#include <QTextStream>
+#include <QDebug>
+
+#include <atomic>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+// QtCore 导出的调试钩子表（qhooks_p.h），每个 QObject 构造和析构时调用，
+// 不依赖私有头文件，这里只声明用到的部分
+QT_BEGIN_NAMESPACE
+extern Q_DECL_IMPORT quintptr qtHookData[];
+QT_END_NAMESPACE
+
+namespace {
+enum HookIndex {
+    AddQObjectHook = 3,
+    RemoveQObjectHook = 4,
+};
+using ObjectCallback = void (*)(QObject *);
+
+// 对象可能在任意线程创建
+std::atomic<int> liveObjects{0};
+ObjectCallback previousAdd = nullptr;
+ObjectCallback previousRemove = nullptr;
+
+void objectAdded(QObject *object)
+{
+    ++liveObjects;
+    if (previousAdd) {
+        previousAdd(object);
+    }
+}
+
+void objectRemoved(QObject *object)
+{
+    --liveObjects;
+    if (previousRemove) {
+        previousRemove(object);
+    }
+}
+}
+
+// 基线之后允许的增长：缓存、连接池等会有小幅波动，持续泄漏会远超这些值
+static const qint64 RSS_SLACK_KB = 4096;
+static const int OBJECT_SLACK = 16;
+static const int REPLY_SLACK = 2;
+static const int SOCKET_SLACK = 4;
+// 单个周期的最长耗时，超过说明流程卡住
+static const int CYCLE_TIMEOUT = 30000;
+
+// 每次发现都返回一个新的 IPv4 地址，让每个周期都产生写入
+class SoakDiscovery : public IpDiscovery
+{
+public:
+    explicit SoakDiscovery(const int &cycle) : IpDiscovery(nullptr), cycle_(cycle) {}
+
+    void discover(int timeout = 30000) override
+    {
+        Q_UNUSED(timeout);
+        QTimer::singleShot(0, this, [this]() {
+            emit discovered(true, QString("198.51.100.%1").arg(cycle_ % 200 + 1));
+            emit failed(false, "No public IPv6");
+            emit finished();
+        });
+    }
+
+private:
+    const int &cycle_;
+};
+
+Soak::Soak(int cycles, QObject *parent)
+    : QObject(parent)
+    , cycles_(cycles)
+    , networkManager_(new QNetworkAccessManager(this))
+    , server_(new MockApiServer(this))
+{
+}
+
+qint64 Soak::residentKb()
+{
+#ifdef Q_OS_LINUX
+    // 第二项为常驻内存页数
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+#else
+    return -1;
+#endif
+}
+
+int Soak::openSockets()
+{
+#ifdef Q_OS_LINUX
+    // 客户端和模拟服务器两端的连接都计入
+    QDir dir("/proc/self/fd");
+    int sockets = 0;
+    const QStringList entries = dir.entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot);
+    for (const QString &entry : entries) {
+        if (QFile::symLinkTarget(dir.filePath(entry)).contains("socket:")) {
+            ++sockets;
+        }
+    }
+    return sockets;
+#else
+    return -1;
+#endif
+}
+
+Soak::Sample Soak::sample() const
+{
+    Sample sample;
+    sample.cycle = cycle_;
+    sample.rss = residentKb();
+    // 安装钩子之后创建且仍存活的全部对象，没有父对象的也计入
+    sample.objects = liveObjects.load();
+    sample.replies = networkManager_->findChildren<QNetworkReply *>().size();
+    sample.inFlight = service_->requestManager()->inFlightCount();
+    sample.sockets = openSockets();
+    return sample;
+}
+
+void Soak::print(const Sample &sample) const
+{
+    QTextStream(stdout) << QString("cycle %1  rss=%2 KB  objects=%3  replies=%4  in-flight=%5  sockets=%6\n")
+                               .arg(sample.cycle)
+                               .arg(sample.rss)
+                               .arg(sample.objects)
+                               .arg(sample.replies)
+                               .arg(sample.inFlight)
+                               .arg(sample.sockets);
+}
+
+void Soak::installObjectHooks()
+{
+    previousAdd = reinterpret_cast<ObjectCallback>(qtHookData[AddQObjectHook]);
+    previousRemove = reinterpret_cast<ObjectCallback>(qtHookData[RemoveQObjectHook]);
+    qtHookData[AddQObjectHook] = reinterpret_cast<quintptr>(&objectAdded);
+    qtHookData[RemoveQObjectHook] = reinterpret_cast<quintptr>(&objectRemoved);
+}
+
+void Soak::removeObjectHooks()
+{
+    qtHookData[AddQObjectHook] = reinterpret_cast<quintptr>(previousAdd);
+    qtHookData[RemoveQObjectHook] = reinterpret_cast<quintptr>(previousRemove);
+}
+
+int Soak::run()
+{
+    // 状态文件写到测试目录，不影响真实的缓存和待发送队列
+    QStandardPaths::setTestModeEnabled(true);
+    const QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QFile::remove(dataPath + "/pending.json");
+    QFile::remove(dataPath + "/state.json");
+    QDir(Journal::defaultDirectory()).removeRecursively();
+
+    if (!server_->listen(0)) {
+        return 1;
+    }
+    // 之前创建的对象不计入，只比较基线前后的差值
+    installObjectHooks();
+    const QString endpoint = QString("http://127.0.0.1:%1/").arg(server_->port());
+
+    QJsonObject providers;
+    providers["Aliyun"] = QJsonObject{{"access_key", "soak"}, {"secret_key", "soak"},
+                                      {"domain", "example.com"}, {"endpoint", endpoint}};
+    providers["DNSPod"] = QJsonObject{{"token", "1,soak"}, {"domain", "example.com"}, {"endpoint", endpoint}};
+    providers["Cloudflare"] = QJsonObject{{"api_key", "soak"}, {"zone_id", "soak"},
+                                          {"domain", "example.com"}, {"endpoint", endpoint}};
+
+    QJsonObject settings;
+    settings[KEY_TARGET_PROVIDERS] = QJsonArray{"Aliyun", "DNSPod", "Cloudflare"};
+    settings[KEY_HOST_COORDINATION] = false;
+    settings["ipv4_record"] = "soak";
+    settings["ttl"] = 600;
+    settings["providers"] = providers;
+    Config::getInstance().setConfig(settings);
+
+    service_ = new DdnsService(networkManager_, this);
+    service_->openJournal();
+    service_->setDiscovery(new SoakDiscovery(cycle_));
+    service_->reachability()->setOnline(true);
+    service_->reloadConfig();
+    service_->setFamilyEnabled(false, false);
+    // 每个新地址立即提交，不等稳定窗口
+    service_->setDampingEnabled(false);
+
+    connect(service_->dispatcher(), &UpdateDispatcher::cycleFinished, this,
+            [this](bool success) { onCycleFinished(success); });
+    connect(service_, &DdnsService::configError, this, [this](const QString &message) {
+        qCritical() << "soak: configuration error:" << message;
+        loop_.exit(1);
+    });
+
+    // 头几个周期会建立连接池和各种缓存，之后的状态作为基线
+    warmup_ = qMin(qBound(10, cycles_ / 10, 500), cycles_ / 2);
+    sampleEvery_ = qMax(1, cycles_ / 20);
+
+    QElapsedTimer wall;
+    wall.start();
+    service_->start();
+    QTimer::singleShot(0, this, &Soak::nextCycle);
+    const int result = loop_.exec();
+    service_->stop();
+    removeObjectHooks();
+    if (result != 0) {
+        return result;
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1 cycles in %2 ms, %3 failed, %4 requests over %5 connection(s)\n")
+               .arg(cycle_)
+               .arg(wall.elapsed())
+               .arg(failures_)
+               .arg(server_->requestCount())
+               .arg(server_->connectionCount());
+
+    QStringList problems = check(baseline_, samples_.last());
+    if (failures_ > 0) {
+        problems.append(QString("%1 cycle(s) failed").arg(failures_));
+    }
+    if (!problems.isEmpty()) {
+        out << "FAILED: " << problems.join("; ") << "\n";
+        return 1;
+    }
+    out << "OK: no growth beyond bounds after warmup\n";
+    return 0;
+}
+
+void Soak::nextCycle()
+{
+    // 上一周期释放的对象已处理完，此时采样最能反映稳定状态
+    if (cycle_ == warmup_) {
+        baseline_ = sample();
+        samples_.append(baseline_);
+        print(baseline_);
+    } else if (cycle_ > warmup_ && (cycle_ % sampleEvery_ == 0 || cycle_ == cycles_)) {
+        samples_.append(sample());
+        print(samples_.last());
+    }
+
+    if (cycle_ >= cycles_) {
+        loop_.exit(0);
+        return;
+    }
+
+    ++cycle_;
+    watchdog_ = TimerWheel::getInstance().schedule(CYCLE_TIMEOUT, this, [this]() {
+        qCritical() << "soak: cycle" << cycle_ << "did not finish";
+        loop_.exit(1);
+    });
+    service_->refreshAddresses();
+}
+
+void Soak::onCycleFinished(bool success)
+{
+    TimerWheel::getInstance().cancel(watchdog_);
+    if (!success) {
+        ++failures_;
+    }
+    // 让延迟删除的请求句柄先释放
+    QTimer::singleShot(0, this, &Soak::nextCycle);
+}
+
+QStringList Soak::check(const Sample &baseline, const Sample &last) const
+{
+    QStringList problems;
+    if (baseline.rss >= 0 && last.rss - baseline.rss > RSS_SLACK_KB) {
+        problems.append(QString("RSS grew by %1 KB").arg(last.rss - baseline.rss));
+    }
+    if (last.objects - baseline.objects > OBJECT_SLACK) {
+        problems.append(QString("QObject count grew from %1 to %2").arg(baseline.objects).arg(last.objects));
+    }
+    if (last.replies - baseline.replies > REPLY_SLACK) {
+        problems.append(QString("live QNetworkReply count grew from %1 to %2").arg(baseline.replies).arg(last.replies));
+    }
+    if (baseline.sockets >= 0 && last.sockets - baseline.sockets > SOCKET_SLACK) {
+        problems.append(QString("open sockets grew from %1 to %2").arg(baseline.sockets).arg(last.sockets));
+    }
+    return problems;
+}
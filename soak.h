@@ -0,0 +1,64 @@
+#ifndef SOAK_H
+#define SOAK_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QEventLoop>
+#include <QNetworkAccessManager>
+
+#include "ddnsservice.h"
+#include "mockapiserver.h"
+
+// 长时间运行测试：对本地模拟接口连续执行大量更新周期，
+// 定期采样内存占用、存活对象数、网络请求数和打开的套接字数，任何一项持续增长即判定失败
+//
+// 每个周期都换一个地址，保证阿里云、DNSPod 和 Cloudflare 都真正发出写入请求。
+class Soak : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Soak(int cycles, QObject *parent = nullptr);
+
+    int run();
+
+private:
+    struct Sample {
+        int cycle = 0;
+        qint64 rss = -1;        // KB，不支持的平台为 -1
+        int objects = 0;
+        int replies = 0;
+        int inFlight = 0;
+        int sockets = -1;       // 不支持的平台为 -1
+    };
+
+    // 通过 Qt 的对象钩子统计存活的 QObject
+    static void installObjectHooks();
+    static void removeObjectHooks();
+    static qint64 residentKb();
+    static int openSockets();
+    Sample sample() const;
+    void nextCycle();
+    void onCycleFinished(bool success);
+    void print(const Sample &sample) const;
+    // 与基线比较，超出允许的增长时返回描述
+    QStringList check(const Sample &baseline, const Sample &last) const;
+
+private:
+    int cycles_;
+    int cycle_ = 0;
+    int failures_ = 0;
+    quint64 watchdog_ = 0;
+
+    QEventLoop loop_;
+    QNetworkAccessManager *networkManager_;
+    MockApiServer *server_;
+    DdnsService *service_ = nullptr;
+
+    QList<Sample> samples_;
+    Sample baseline_;
+    int warmup_ = 0;
+    int sampleEvery_ = 1;
+};
+
+#endif // SOAK_H
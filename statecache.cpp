@@ -0,0 +1,110 @@
+#include "statecache.h"
+
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+QString StateCache::getStateFilePath() const
+{
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir dir(dataPath);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    return dataPath + "/state.json";
+}
+
+bool StateCache::load()
+{
+    QFile file(getStateFilePath());
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open state cache for reading:" << file.errorString();
+        return false;
+    }
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (doc.isNull()) {
+        qWarning() << "Failed to parse state cache:" << error.errorString();
+        return false;
+    }
+    state_ = doc.object();
+    return true;
+}
+
+bool StateCache::save() const
+{
+    // 原子写入，避免进程被杀时留下半个文件
+    QSaveFile file(getStateFilePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not save state cache:" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(state_).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+void StateCache::setAddress(bool isIpv4, const QString &address, const QDateTime &time)
+{
+    const QString key = isIpv4 ? "ipv4" : "ipv6";
+    QJsonObject entry;
+    entry["address"] = address;
+    entry["time"] = time.toString(Qt::ISODate);
+    state_[key] = entry;
+}
+
+QString StateCache::address(bool isIpv4) const
+{
+    return state_[isIpv4 ? "ipv4" : "ipv6"].toObject()["address"].toString();
+}
+
+QDateTime StateCache::addressTime(bool isIpv4) const
+{
+    return QDateTime::fromString(state_[isIpv4 ? "ipv4" : "ipv6"].toObject()["time"].toString(), Qt::ISODate);
+}
+
+void StateCache::setPublished(const QString &provider, const Published &published)
+{
+    QJsonObject entry;
+    entry["ipv4"] = published.ipv4;
+    entry["ipv6"] = published.ipv6;
+    entry["records"] = QJsonArray::fromStringList(published.records);
+    entry["ttl"] = published.ttl;
+    entry["success"] = published.success;
+    entry["message"] = published.message;
+    entry["time"] = published.time.toString(Qt::ISODate);
+
+    QJsonObject providers = state_["published"].toObject();
+    providers[provider] = entry;
+    state_["published"] = providers;
+}
+
+StateCache::Published StateCache::published(const QString &provider) const
+{
+    QJsonObject entry = state_["published"].toObject()[provider].toObject();
+    Published published;
+    published.ipv4 = entry["ipv4"].toString();
+    published.ipv6 = entry["ipv6"].toString();
+    for (const QJsonValue &record : entry["records"].toArray()) {
+        published.records.append(record.toString());
+    }
+    published.ttl = entry["ttl"].toInt(1);
+    published.success = entry["success"].toBool();
+    published.message = entry["message"].toString();
+    published.time = QDateTime::fromString(entry["time"].toString(), Qt::ISODate);
+    return published;
+}
+
+bool StateCache::isPublished(const QString &provider, const QString &ipv4, const QString &ipv6,
+                             const QStringList &records, int ttl) const
+{
+    Published last = published(provider);
+    return last.success && last.ipv4 == ipv4 && last.ipv6 == ipv6 && last.records == records && last.ttl == ttl;
+}
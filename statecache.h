@@ -0,0 +1,46 @@
+#ifndef STATECACHE_H
+#define STATECACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QJsonObject>
+
+// 持久化最后确认的地址以及各服务商最后一次写入的结果
+class StateCache
+{
+public:
+    struct Published {
+        QString ipv4;
+        QString ipv6;
+        // 故障切换和各出口的记录，"类型 名称 内容"，已排序
+        QStringList records;
+        int ttl = 1;
+        bool success = false;
+        QString message;
+        QDateTime time;
+    };
+
+    bool load();
+    bool save() const;
+
+    bool isEmpty() const { return state_.isEmpty(); }
+
+    void setAddress(bool isIpv4, const QString &address, const QDateTime &time = QDateTime::currentDateTime());
+    QString address(bool isIpv4) const;
+    QDateTime addressTime(bool isIpv4) const;
+
+    void setPublished(const QString &provider, const Published &published);
+    Published published(const QString &provider) const;
+    // 该服务商是否已成功写入相同内容
+    bool isPublished(const QString &provider, const QString &ipv4, const QString &ipv6,
+                     const QStringList &records, int ttl) const;
+
+private:
+    QString getStateFilePath() const;
+
+private:
+    QJsonObject state_;
+};
+
+#endif // STATECACHE_H
@@ -0,0 +1,243 @@
+#include "timerwheel.h"
+
+#include <QCoreApplication>
+#include <QtAlgorithms>
+#include <QDebug>
+#include <utility>
+
+// 从 start 槽开始（含）到下一个非空槽的距离
+static int distanceToNext(quint64 bits, int start)
+{
+    start &= 63;
+    const quint64 rotated = start ? (bits >> start) | (bits << (64 - start)) : bits;
+    return qCountTrailingZeroBits(rotated);
+}
+
+TimerWheel &TimerWheel::getInstance()
+{
+    // 随应用对象一起销毁，避免在事件循环结束后才析构定时器
+    static QPointer<TimerWheel> instance;
+    if (!instance) {
+        instance = new TimerWheel(QCoreApplication::instance());
+    }
+    return *instance;
+}
+
+TimerWheel::TimerWheel(QObject *parent)
+    : QObject(parent)
+    , wakeTimer_(new QTimer(this))
+{
+    wakeTimer_->setSingleShot(true);
+    wakeTimer_->setTimerType(Qt::PreciseTimer);
+    connect(wakeTimer_, &QTimer::timeout, this, &TimerWheel::poll);
+}
+
+qint64 TimerWheel::nextDeadline() const
+{
+    const qint64 next = nextEventTick();
+    return next < 0 ? -1 : next * TICK_MS;
+}
+
+void TimerWheel::poll()
+{
+    ++wakeups_;
+    advance(nowTick());
+    rearm();
+}
+
+TimerWheel::TimerId TimerWheel::schedule(int delay, QObject *context, std::function<void()> callback, int slack)
+{
+    // 空闲时直接对齐到当前时刻，不用逐格追赶
+    if (entries_.isEmpty()) {
+        currentTick_ = nowTick();
+    }
+
+    // 向上取整到格，保证不会提前触发
+    qint64 expires = (Clock::elapsed() + qMax(0, delay) + TICK_MS - 1) / TICK_MS;
+    if (slack >= TICK_MS) {
+        const qint64 align = slack / TICK_MS;
+        expires = (expires + align - 1) / align * align;
+    }
+    // 当前格已经处理过，最早只能排到下一格
+    expires = qMax(expires, currentTick_ + 1);
+
+    const TimerId id = nextId_++;
+    Entry &entry = entries_[id];
+    entry.expires = expires;
+    entry.context = context;
+    entry.callback = std::move(callback);
+    insert(id, entry);
+
+    rearm();
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+    auto it = entries_.find(id);
+    if (it == entries_.end()) {
+        return false;
+    }
+
+    unlink(it.value(), id);
+    entries_.erase(it);
+    if (entries_.isEmpty()) {
+        wakeTimer_->stop();
+    }
+    return true;
+}
+
+qint64 TimerWheel::remainingTime(TimerId id) const
+{
+    auto it = entries_.constFind(id);
+    if (it == entries_.constEnd()) {
+        return -1;
+    }
+    return qMax<qint64>(0, it.value().expires * TICK_MS - Clock::elapsed());
+}
+
+void TimerWheel::insert(TimerId id, Entry &entry)
+{
+    qint64 delta = entry.expires - currentTick_;
+    qint64 expires = entry.expires;
+
+    // 超出最高层范围的先放在最高层，转一圈后重新计算位置
+    const qint64 range = qint64(1) << (SLOT_BITS * LEVELS);
+    if (delta >= range) {
+        delta = range - 1;
+        expires = currentTick_ + delta;
+    }
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (qint64(1) << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    entry.level = level;
+    entry.slot = int((expires >> (SLOT_BITS * level)) & (SLOTS - 1));
+    wheel_[level][entry.slot].insert(id);
+    occupied_[level] |= quint64(1) << entry.slot;
+}
+
+void TimerWheel::unlink(const Entry &entry, TimerId id)
+{
+    QSet<TimerId> &slot = wheel_[entry.level][entry.slot];
+    slot.remove(id);
+    if (slot.isEmpty()) {
+        occupied_[entry.level] &= ~(quint64(1) << entry.slot);
+    }
+}
+
+qint64 TimerWheel::nextEventTick() const
+{
+    qint64 next = -1;
+    for (int level = 0; level < LEVELS; ++level) {
+        if (!occupied_[level]) {
+            continue;
+        }
+
+        // 第 0 层是到期时刻，更高层是需要下放到低层的时刻
+        const qint64 base = currentTick_ >> (SLOT_BITS * level);
+        const int distance = distanceToNext(occupied_[level], int(base & (SLOTS - 1)) + 1) + 1;
+        const qint64 tick = (base + distance) << (SLOT_BITS * level);
+        if (next < 0 || tick < next) {
+            next = tick;
+        }
+    }
+    return next;
+}
+
+void TimerWheel::advance(qint64 target)
+{
+    while (currentTick_ < target) {
+        // 中间没有需要处理的槽，直接跳过
+        const qint64 next = nextEventTick();
+        if (next < 0 || next > target) {
+            currentTick_ = target;
+            break;
+        }
+        currentTick_ = next;
+
+        for (int level = LEVELS - 1; level > 0; --level) {
+            const qint64 mask = (qint64(1) << (SLOT_BITS * level)) - 1;
+            if ((currentTick_ & mask) == 0) {
+                cascade(level);
+            }
+        }
+        expire();
+    }
+}
+
+void TimerWheel::cascade(int level)
+{
+    const int index = int((currentTick_ >> (SLOT_BITS * level)) & (SLOTS - 1));
+    const QSet<TimerId> ids = std::exchange(wheel_[level][index], QSet<TimerId>());
+    occupied_[level] &= ~(quint64(1) << index);
+
+    for (TimerId id : ids) {
+        insert(id, entries_[id]);
+    }
+}
+
+void TimerWheel::expire()
+{
+    const int index = int(currentTick_ & (SLOTS - 1));
+    const QSet<TimerId> ids = std::exchange(wheel_[0][index], QSet<TimerId>());
+    occupied_[0] &= ~(quint64(1) << index);
+
+    for (TimerId id : ids) {
+        // 可能已被同一格中先执行的回调取消
+        auto it = entries_.find(id);
+        if (it == entries_.end()) {
+            continue;
+        }
+
+        Entry entry = std::move(it.value());
+        entries_.erase(it);
+        if (entry.context) {
+            entry.callback();
+        }
+    }
+}
+
+void TimerWheel::rearm()
+{
+    const qint64 next = nextEventTick();
+    // 虚拟时钟下由模拟器调用 poll()
+    if (next < 0 || Clock::isVirtual()) {
+        wakeTimer_->stop();
+        return;
+    }
+
+    const qint64 msec = next * TICK_MS - Clock::elapsed();
+    wakeTimer_->start(int(qMax<qint64>(0, msec)));
+}
+
+void WheelTimer::start(int msec)
+{
+    stop();
+    interval_ = msec;
+    id_ = TimerWheel::getInstance().schedule(msec, this, [this]() { fire(); }, slack_);
+}
+
+void WheelTimer::stop()
+{
+    if (id_ != 0) {
+        TimerWheel::getInstance().cancel(id_);
+        id_ = 0;
+    }
+}
+
+int WheelTimer::remainingTime() const
+{
+    return id_ != 0 ? int(TimerWheel::getInstance().remainingTime(id_)) : -1;
+}
+
+void WheelTimer::fire()
+{
+    id_ = 0;
+    if (!singleShot_) {
+        start(interval_);
+    }
+    emit timeout();
+}
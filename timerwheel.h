@@ -0,0 +1,115 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QPointer>
+#include <QTimer>
+#include <functional>
+
+#include "clock.h"
+
+// 分层时间轮：所有周期检测、校验、重试和超时共用一个底层定时器
+//
+// 4 层 x 64 槽，每格 100 ms，覆盖约 19 天，更远的截止时间在最高层循环等待。
+// 添加、取消为 O(1)；定时器只在下一个非空槽到期时唤醒，相近的截止时间合并为一次唤醒。
+class TimerWheel : public QObject
+{
+    Q_OBJECT
+public:
+    using TimerId = quint64;
+
+    static const int TICK_MS = 100;
+
+    static TimerWheel &getInstance();
+    TimerWheel(const TimerWheel &) = delete;
+
+    // delay 毫秒后在 context 所在线程调用 callback；context 销毁后不再调用
+    // slack 允许推迟的毫秒数，相同 slack 的截止时间对齐到同一时刻
+    TimerId schedule(int delay, QObject *context, std::function<void()> callback, int slack = 0);
+    bool cancel(TimerId id);
+    bool isPending(TimerId id) const { return entries_.contains(id); }
+    // 剩余毫秒数，未安排时返回 -1
+    qint64 remainingTime(TimerId id) const;
+
+    int pendingCount() const { return entries_.size(); }
+    quint64 wakeups() const { return wakeups_; }
+
+    // 下一次需要处理的时刻（Clock 毫秒），没有待处理项时返回 -1
+    qint64 nextDeadline() const;
+    // 处理到当前时刻为止到期的项；虚拟时钟下由模拟器推进时间后调用
+    void poll();
+
+private:
+    explicit TimerWheel(QObject *parent = nullptr);
+
+    struct Entry
+    {
+        qint64 expires = 0;
+        int level = 0;
+        int slot = 0;
+        QPointer<QObject> context;
+        std::function<void()> callback;
+    };
+
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+
+    qint64 nowTick() const { return Clock::elapsed() / TICK_MS; }
+    void insert(TimerId id, Entry &entry);
+    void unlink(const Entry &entry, TimerId id);
+    qint64 nextEventTick() const;
+    void advance(qint64 target);
+    void cascade(int level);
+    void expire();
+    void rearm();
+
+private:
+    QTimer *wakeTimer_;
+
+    QHash<TimerId, Entry> entries_;
+    QSet<TimerId> wheel_[LEVELS][SLOTS];
+    // 每层非空槽的位图，用于直接跳到下一个需要处理的时刻
+    quint64 occupied_[LEVELS] = {};
+
+    qint64 currentTick_ = 0;
+    TimerId nextId_ = 1;
+    quint64 wakeups_ = 0;
+};
+
+// 与 QTimer 用法相同的定时器，由 TimerWheel 驱动
+class WheelTimer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WheelTimer(QObject *parent = nullptr) : QObject(parent) {}
+    ~WheelTimer() override { stop(); }
+
+    void setInterval(int msec) { interval_ = msec; }
+    int interval() const { return interval_; }
+    void setSingleShot(bool singleShot) { singleShot_ = singleShot; }
+    // 允许推迟触发的毫秒数，用于与其他定时任务合并唤醒
+    void setSlack(int msec) { slack_ = msec; }
+
+    void start(int msec);
+    void start() { start(interval_); }
+    void stop();
+    bool isActive() const { return id_ != 0; }
+    int remainingTime() const;
+
+signals:
+    void timeout();
+
+private:
+    void fire();
+
+private:
+    TimerWheel::TimerId id_ = 0;
+    int interval_ = 0;
+    int slack_ = 0;
+    bool singleShot_ = false;
+};
+
+#endif // TIMERWHEEL_H
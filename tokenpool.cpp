@@ -0,0 +1,165 @@
+#include "tokenpool.h"
+#include "clock.h"
+
+#include <QJsonArray>
+#include <QDebug>
+
+// Cloudflare 按 5 分钟窗口限制请求数
+static const qint64 RATE_WINDOW = 300000;
+static const int DEFAULT_RATE_LIMIT = 1200;
+// 隔离的初始时长和上限，权限可能只是暂时被收回
+static const qint64 ISOLATION_BACKOFF = 5 * 60 * 1000;
+static const qint64 MAX_ISOLATION_BACKOFF = 6 * 60 * 60 * 1000;
+
+void TokenPool::loadConfig(const QString &apiKey, const QJsonArray &tokens)
+{
+    QList<Token> loaded;
+    auto add = [this, &loaded](const QString &value, const QStringList &zones, int limit) {
+        if (value.isEmpty()) {
+            return;
+        }
+        for (const Token &t : std::as_const(loaded)) {
+            if (t.token == value) {
+                return;
+            }
+        }
+
+        Token token;
+        for (const Token &t : std::as_const(tokens_)) {
+            if (t.token == value) {
+                token.used = t.used;
+                token.windowStart = t.windowStart;
+                break;
+            }
+        }
+        token.token = value;
+        token.zones = zones;
+        token.limit = limit > 0 ? limit : DEFAULT_RATE_LIMIT;
+        loaded.append(token);
+    };
+
+    add(apiKey.trimmed(), QStringList(), DEFAULT_RATE_LIMIT);
+    for (const QJsonValue &value : tokens) {
+        if (value.isString()) {
+            add(value.toString().trimmed(), QStringList(), DEFAULT_RATE_LIMIT);
+            continue;
+        }
+
+        const QJsonObject obj = value.toObject();
+        QStringList zones;
+        const QJsonArray zoneArray = obj["zones"].toArray();
+        for (const QJsonValue &zone : zoneArray) {
+            zones.append(zone.toString());
+        }
+        add(obj["token"].toString().trimmed(), zones, obj["rate_limit"].toInt(DEFAULT_RATE_LIMIT));
+    }
+
+    tokens_ = loaded;
+    next_ = 0;
+}
+
+bool TokenPool::permits(const Token &token, const QString &zone) const
+{
+    return token.zones.isEmpty() || token.zones.contains(zone);
+}
+
+bool TokenPool::isIsolated(const Token &token)
+{
+    return token.isolated && Clock::elapsed() - token.isolatedSince < token.backoff;
+}
+
+int TokenPool::remaining(Token &token)
+{
+    const qint64 now = Clock::elapsed();
+    if (token.windowStart < 0 || now - token.windowStart >= RATE_WINDOW) {
+        token.windowStart = now;
+        token.used = 0;
+    }
+    return token.limit - token.used;
+}
+
+int TokenPool::usableCount(const QString &zone) const
+{
+    int count = 0;
+    for (const Token &token : tokens_) {
+        if (!isIsolated(token) && permits(token, zone)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+int TokenPool::acquire(const QString &zone)
+{
+    int best = -1;
+    int bestRemaining = 0;
+    for (int i = 0; i < tokens_.size(); ++i) {
+        const int index = (next_ + i) % tokens_.size();
+        Token &token = tokens_[index];
+        if (isIsolated(token) || !permits(token, zone)) {
+            continue;
+        }
+
+        // 全部用完时仍选最接近恢复的令牌，由服务端返回限流错误
+        const int left = remaining(token);
+        if (best < 0 || left > bestRemaining) {
+            best = index;
+            bestRemaining = left;
+        }
+    }
+
+    if (best < 0) {
+        return -1;
+    }
+    tokens_[best].used++;
+    next_ = (best + 1) % tokens_.size();
+    return best;
+}
+
+void TokenPool::isolate(int index, const QString &reason)
+{
+    // 同一轮中已发出的其他请求也会失败，只计一次
+    if (index < 0 || index >= tokens_.size() || isIsolated(tokens_[index])) {
+        return;
+    }
+    Token &token = tokens_[index];
+    token.isolated = true;
+    token.reason = reason;
+    token.backoff = token.backoff > 0 ? qMin(token.backoff * 2, MAX_ISOLATION_BACKOFF) : ISOLATION_BACKOFF;
+    token.isolatedSince = Clock::elapsed();
+    qWarning() << QString("API token #%1 isolated for %2 s: %3").arg(index + 1).arg(token.backoff / 1000).arg(reason);
+}
+
+void TokenPool::confirm(int index)
+{
+    if (index < 0 || index >= tokens_.size() || !tokens_[index].isolated) {
+        return;
+    }
+    Token &token = tokens_[index];
+    token.isolated = false;
+    token.reason.clear();
+    token.backoff = 0;
+    qInfo() << QString("API token #%1 usable again").arg(index + 1);
+}
+
+void TokenPool::exhaust(int index)
+{
+    if (index < 0 || index >= tokens_.size()) {
+        return;
+    }
+    Token &token = tokens_[index];
+    remaining(token);
+    token.used = token.limit;
+    qWarning() << QString("API token #%1 rate limited").arg(index + 1);
+}
+
+QString TokenPool::describe() const
+{
+    QStringList parts;
+    for (int i = 0; i < tokens_.size(); ++i) {
+        const Token &token = tokens_.at(i);
+        parts.append(isIsolated(token) ? QString("#%1 isolated (%2)").arg(i + 1).arg(token.reason)
+                                    : QString("#%1 %2/%3").arg(i + 1).arg(token.used).arg(token.limit));
+    }
+    return parts.join(", ");
+}
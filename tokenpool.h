@@ -0,0 +1,64 @@
+#ifndef TOKENPOOL_H
+#define TOKENPOOL_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QJsonObject>
+#include <QJsonArray>
+
+// API 令牌池：请求按各令牌剩余额度和区域权限分配，认证失败的令牌自动隔离，隔离到期后重试
+//
+// "api_tokens": [ "token", { "token": "...", "zones": ["zone id"], "rate_limit": 1200 } ]
+// zones 为空表示可用于所有区域；rate_limit 为每个窗口（5 分钟）内允许的请求数。
+class TokenPool
+{
+public:
+    struct Token {
+        QString token;
+        QStringList zones;
+        int limit = 1200;
+        int used = 0;
+        // 当前窗口的开始时间（Clock::elapsed()），-1 表示尚未开始
+        qint64 windowStart = -1;
+        bool isolated = false;
+        QString reason;
+        // 隔离到期后重试一次，再次失败时隔离时间加倍
+        qint64 isolatedSince = 0;
+        qint64 backoff = 0;
+    };
+
+    // 重新加载时保留仍存在的令牌的用量；隔离状态清除，重新填写令牌后立即可用
+    void loadConfig(const QString &apiKey, const QJsonArray &tokens);
+
+    bool isEmpty() const { return tokens_.isEmpty(); }
+    int size() const { return tokens_.size(); }
+    const Token &token(int index) const { return tokens_.at(index); }
+
+    // 可用于该区域且未被隔离的令牌数
+    int usableCount(const QString &zone) const;
+    // 选出剩余额度最多的令牌并计入一次请求，没有可用令牌时返回 -1
+    int acquire(const QString &zone);
+
+    // 401/403：令牌无效或没有权限，在退避时间内不再分配请求
+    void isolate(int index, const QString &reason);
+    // 请求成功，清除该令牌的退避
+    void confirm(int index);
+    // 429：本窗口额度已用完
+    void exhaust(int index);
+
+    QString describe() const;
+
+private:
+    bool permits(const Token &token, const QString &zone) const;
+    // 处于隔离期内
+    static bool isIsolated(const Token &token);
+    static int remaining(Token &token);
+
+private:
+    QList<Token> tokens_;
+    // 额度相同时轮流使用
+    int next_ = 0;
+};
+
+#endif // TOKENPOOL_H
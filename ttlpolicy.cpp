@@ -0,0 +1,46 @@
+#include "ttlpolicy.h"
+#include "clock.h"
+
+#include <QtGlobal>
+
+// 自动 TTL 按 Cloudflare 的 300 秒计算
+static const int AUTO_TTL = 300;
+static const int MIN_VERIFY_INTERVAL = 60;
+static const int MAX_VERIFY_INTERVAL = 3600;
+
+void TtlPolicy::loadConfig(int ttl, const QJsonObject &dynamicTtl)
+{
+    ttl_ = ttl > 0 ? ttl : 1;
+    dynamic_ = dynamicTtl["enabled"].toBool(false);
+    unstableTtl_ = dynamicTtl["unstable_ttl"].toInt(60);
+    quietPeriod_ = qint64(dynamicTtl["quiet_period"].toDouble(1800) * 1000);
+}
+
+void TtlPolicy::noteInstability()
+{
+    lastChange_ = Clock::elapsed();
+}
+
+bool TtlPolicy::isUnstable() const
+{
+    return lastChange_ >= 0 && Clock::elapsed() - lastChange_ < quietPeriod_;
+}
+
+int TtlPolicy::recordTtl() const
+{
+    if (dynamic_ && isUnstable()) {
+        int base = ttl_ == 1 ? AUTO_TTL : ttl_;
+        return qMin(unstableTtl_, base);
+    }
+    return ttl_;
+}
+
+int TtlPolicy::verifyInterval() const
+{
+    // 解析器最多缓存一个 TTL，更频繁的校验没有意义
+    int ttl = recordTtl();
+    if (ttl == 1) {
+        ttl = AUTO_TTL;
+    }
+    return qBound(MIN_VERIFY_INTERVAL, ttl, MAX_VERIFY_INTERVAL) * 1000;
+}
@@ -0,0 +1,31 @@
+#ifndef TTLPOLICY_H
+#define TTLPOLICY_H
+
+#include <QJsonObject>
+#include <QtGlobal>
+
+// 根据记录 TTL 决定校验周期；地址不稳定时临时降低 TTL
+class TtlPolicy
+{
+public:
+    void loadConfig(int ttl, const QJsonObject &dynamicTtl);
+
+    // 地址发生变化或出现待确认的新地址
+    void noteInstability();
+
+    bool isUnstable() const;
+    // 当前应写入记录的 TTL（秒），1 表示由服务商自动决定
+    int recordTtl() const;
+    // 下次校验的间隔（毫秒）
+    int verifyInterval() const;
+
+private:
+    // 上次不稳定的时刻，-1 表示从未发生
+    qint64 lastChange_ = -1;
+    int ttl_ = 1;
+    bool dynamic_ = false;
+    int unstableTtl_ = 60;
+    qint64 quietPeriod_ = 1800000;
+};
+
+#endif // TTLPOLICY_H
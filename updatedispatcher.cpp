@@ -0,0 +1,106 @@
+#include "updatedispatcher.h"
+
+#include <QDebug>
+
+void UpdateDispatcher::start(const QList<DnsProvider *> &providers, const QList<DnsRecord> &records)
+{
+    if (isRunning()) {
+        qWarning() << QString("update cycle %1 superseded by a newer one").arg(cycle_);
+        cancel();
+    }
+
+    // 断开上一轮的连接，避免迟到的结果计入本轮
+    for (DnsProvider *provider : std::as_const(providers_)) {
+        disconnect(provider, &DnsProvider::updateFinished, this, nullptr);
+    }
+
+    const quint64 cycle = ++cycle_;
+    const QDeadlineTimer deadline(cycleBudget_);
+    providers_ = providers;
+    statuses_.clear();
+    pending_ = providers_.size();
+    elapsed_.start();
+    emit cycleStarted(cycle);
+
+    for (int i = 0; i < providers_.size(); ++i) {
+        ProviderStatus status;
+        status.provider = providers_[i]->name();
+        statuses_.append(status);
+    }
+
+    if (pending_ == 0) {
+        emit cycleFinished(true, statuses_);
+        return;
+    }
+
+    for (int i = 0; i < providers_.size(); ++i) {
+        DnsProvider *provider = providers_[i];
+        connect(provider, &DnsProvider::updateFinished, this, [this, cycle, i](bool success, const QString &message) {
+            finishProvider(cycle, i, success, message);
+        });
+
+        provider->beginCycle(cycle, deadline);
+    }
+
+    // 预算用尽时结束整轮，单个服务商超时不影响其他服务商的结果
+    budgetTimer_ = TimerWheel::getInstance().schedule(cycleBudget_, this, [this, cycle]() {
+        for (int i = 0; i < statuses_.size(); ++i) {
+            if (cycle == cycle_ && !statuses_[i].finished) {
+                providers_[i]->abortCycle();
+                finishProvider(cycle, i, false, "cycle deadline exceeded");
+            }
+        }
+    });
+
+    // 先全部建立连接再启动，避免同步失败时漏掉结果
+    for (DnsProvider *provider : std::as_const(providers_)) {
+        provider->updateDnsRecords(records);
+    }
+}
+
+void UpdateDispatcher::cancel()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    for (int i = 0; i < statuses_.size(); ++i) {
+        if (!statuses_[i].finished) {
+            providers_[i]->abortCycle();
+        }
+    }
+    pending_ = 0;
+    TimerWheel::getInstance().cancel(budgetTimer_);
+    emit cycleCancelled(cycle_);
+}
+
+void UpdateDispatcher::finishProvider(quint64 cycle, int index, bool success, const QString &message)
+{
+    if (cycle != cycle_ || pending_ == 0 || index >= statuses_.size() || statuses_[index].finished) {
+        return;
+    }
+
+    ProviderStatus &status = statuses_[index];
+    status.finished = true;
+    status.success = success;
+    status.message = message;
+    status.elapsedMs = elapsed_.elapsed();
+
+    qInfo() << QString("%1 update %2 in %3 ms: %4")
+                   .arg(status.provider)
+                   .arg(success ? "succeeded" : "failed")
+                   .arg(status.elapsedMs)
+                   .arg(message);
+    emit providerFinished(status);
+
+    if (--pending_ > 0) {
+        return;
+    }
+    TimerWheel::getInstance().cancel(budgetTimer_);
+
+    bool allSuccess = true;
+    for (const ProviderStatus &s : std::as_const(statuses_)) {
+        allSuccess = allSuccess && s.success;
+    }
+    emit cycleFinished(allSuccess, statuses_);
+}
@@ -0,0 +1,58 @@
+#ifndef UPDATEDISPATCHER_H
+#define UPDATEDISPATCHER_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QElapsedTimer>
+
+#include "dnsprovider.h"
+#include "timerwheel.h"
+
+struct ProviderStatus
+{
+    QString provider;
+    bool finished = false;
+    bool success = false;
+    QString message;
+    qint64 elapsedMs = 0;
+};
+
+// 将同一次更新并行分发到多个服务商，并汇总结果
+class UpdateDispatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit UpdateDispatcher(QObject *parent = nullptr) : QObject(parent) {};
+
+    void start(const QList<DnsProvider *> &providers, const QList<DnsRecord> &records);
+
+    // 取代正在进行的一轮：中止其请求并丢弃结果
+    void cancel();
+
+    bool isRunning() const { return pending_ > 0; }
+    quint64 currentCycle() const { return cycle_; }
+    const QList<ProviderStatus> &statuses() const { return statuses_; }
+    // 整轮更新的时间预算，所有服务商的全部请求共享
+    void setCycleBudget(int msec) { cycleBudget_ = msec; }
+
+signals:
+    void cycleStarted(quint64 cycle);
+    void cycleCancelled(quint64 cycle);
+    void providerFinished(const ProviderStatus &status);
+    void cycleFinished(bool success, const QList<ProviderStatus> &statuses);
+
+private:
+    void finishProvider(quint64 cycle, int index, bool success, const QString &message);
+
+private:
+    QList<DnsProvider *> providers_;
+    QList<ProviderStatus> statuses_;
+    QElapsedTimer elapsed_;
+    quint64 cycle_ = 0;
+    int pending_ = 0;
+    int cycleBudget_ = 60000;
+    TimerWheel::TimerId budgetTimer_ = 0;
+};
+
+#endif // UPDATEDISPATCHER_H
@@ -0,0 +1,249 @@
+#include "uplinkdiscovery.h"
+#include "timerwheel.h"
+#include "ipdiscovery.h"
+
+#include <QSslSocket>
+#include <QJsonObject>
+#include <QSharedPointer>
+#include <QDebug>
+
+QList<QNetworkInterface> UplinkDiscovery::usableInterfaces()
+{
+    QList<QNetworkInterface> usable;
+    const QList<QNetworkInterface> interfaces = QNetworkInterface::allInterfaces();
+    for (const QNetworkInterface &interface : interfaces) {
+        // 跳过禁用的接口和回环接口
+        if (!(interface.flags() & QNetworkInterface::IsUp) ||
+            !(interface.flags() & QNetworkInterface::IsRunning) ||
+            (interface.flags() & QNetworkInterface::IsLoopBack)) {
+            continue;
+        }
+        usable.append(interface);
+    }
+    return usable;
+}
+
+void UplinkDiscovery::loadConfig(const QJsonArray &config)
+{
+    // 保留已发现的地址，避免重新加载后把相同地址当作变化
+    QList<Uplink> previous = uplinks_;
+    uplinks_.clear();
+    ++generation_;
+    pending_ = 0;
+
+    for (const QJsonValue &value : config) {
+        const QJsonObject object = value.toObject();
+        Uplink uplink;
+        uplink.name = object["name"].toString();
+        uplink.interfaceName = object["interface"].toString();
+        uplink.ipv4RecordName = object["ipv4_record"].toString();
+        uplink.ipv6RecordName = object["ipv6_record"].toString();
+
+        const QString source = object["source"].toString();
+        if (!source.isEmpty() && !uplink.source.setAddress(source)) {
+            qWarning() << QString("uplink %1: invalid source address %2").arg(uplink.name, source);
+            continue;
+        }
+        if (uplink.name.isEmpty() || (uplink.interfaceName.isEmpty() && uplink.source.isNull())) {
+            qWarning() << QString("uplink %1 needs an interface or a source address, ignored").arg(uplink.name);
+            continue;
+        }
+
+        for (const Uplink &old : std::as_const(previous)) {
+            if (old.name == uplink.name) {
+                uplink.ipv4 = old.ipv4;
+                uplink.ipv6 = old.ipv6;
+            }
+        }
+        uplinks_.append(uplink);
+    }
+}
+
+QHostAddress UplinkDiscovery::sourceAddress(const Uplink &uplink, bool isIpv4) const
+{
+    const QAbstractSocket::NetworkLayerProtocol family = isIpv4 ? QAbstractSocket::IPv4Protocol
+                                                                : QAbstractSocket::IPv6Protocol;
+    if (!uplink.source.isNull()) {
+        return uplink.source.protocol() == family ? uplink.source : QHostAddress();
+    }
+
+    const QNetworkInterface interface = QNetworkInterface::interfaceFromName(uplink.interfaceName);
+    const QList<QNetworkAddressEntry> entries = interface.addressEntries();
+    for (const QNetworkAddressEntry &entry : entries) {
+        const QHostAddress address = entry.ip();
+        if (address.protocol() != family || address.isLoopback()) {
+            continue;
+        }
+        // IPv6 只用全局地址，链路本地和 ULA 地址出不了本地网络
+        if (!isIpv4 && (!address.isGlobal() || address.isUniqueLocalUnicast())) {
+            continue;
+        }
+        return address;
+    }
+    return QHostAddress();
+}
+
+void UplinkDiscovery::discover(int timeout)
+{
+    if (isRunning()) {
+        qDebug() << "uplink discovery already running";
+        return;
+    }
+
+    QList<QPair<int, bool>> queries;
+    for (int i = 0; i < uplinks_.size(); ++i) {
+        for (bool isIpv4 : {true, false}) {
+            const Uplink &uplink = uplinks_.at(i);
+            // 没有对应记录的地址族不查询
+            if ((isIpv4 ? uplink.ipv4RecordName : uplink.ipv6RecordName).isEmpty()) {
+                continue;
+            }
+            queries.append({i, isIpv4});
+        }
+    }
+    if (queries.isEmpty()) {
+        emit finished();
+        return;
+    }
+
+    pending_ = queries.size();
+    for (const auto &entry : std::as_const(queries)) {
+        const Uplink &uplink = uplinks_.at(entry.first);
+        const QHostAddress source = sourceAddress(uplink, entry.second);
+        if (source.isNull()) {
+            emit failed(uplink.name, entry.second, QString("No %1 source address for uplink %2")
+                                                        .arg(entry.second ? "IPv4" : "IPv6")
+                                                        .arg(uplink.name));
+            finishQuery();
+            continue;
+        }
+        query(entry.first, entry.second, source, timeout);
+    }
+}
+
+void UplinkDiscovery::query(int index, bool isIpv4, const QHostAddress &source, int timeout)
+{
+    const QString name = uplinks_.at(index).name;
+    const QString host = isIpv4 ? "api.ipify.org" : "api6.ipify.org";
+    const quint64 generation = generation_;
+
+    QSslSocket *socket = new QSslSocket(this);
+    QSharedPointer<QByteArray> response(new QByteArray);
+    QSharedPointer<bool> settled(new bool(false));
+
+    // 完成、出错和超时只取最先发生的一个
+    auto finish = [this, socket, settled, generation, index, isIpv4, name, response](const QString &error) {
+        if (*settled) {
+            return;
+        }
+        *settled = true;
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+        if (generation != generation_) {
+            return;
+        }
+        if (error.isEmpty()) {
+            handleResponse(index, isIpv4, *response);
+        } else {
+            emit failed(name, isIpv4, error);
+        }
+        finishQuery();
+    };
+
+    // 源地址决定出口，端口由系统分配
+    if (!socket->bind(source, 0)) {
+        finish(QString("Could not bind to %1: %2").arg(source.toString(), socket->errorString()));
+        return;
+    }
+
+    connect(socket, &QSslSocket::encrypted, this, [socket, host]() {
+        // HTTP/1.0 响应不会使用分块编码，读到连接关闭即为完整响应
+        socket->write(QString("GET /?format=json HTTP/1.0\r\nHost: %1\r\nUser-Agent: ddns-qt/0.1\r\n\r\n")
+                          .arg(host).toLatin1());
+    });
+    connect(socket, &QSslSocket::readyRead, this, [socket, response]() {
+        response->append(socket->readAll());
+    });
+    connect(socket, &QSslSocket::disconnected, this, [finish]() {
+        finish(QString());
+    });
+    connect(socket, &QSslSocket::errorOccurred, this, [socket, finish](QAbstractSocket::SocketError error) {
+        // 服务器关闭连接表示响应结束，随后会收到 disconnected
+        if (error != QAbstractSocket::RemoteHostClosedError) {
+            finish(socket->errorString());
+        }
+    });
+    TimerWheel::getInstance().schedule(timeout, socket, [finish, name]() {
+        qWarning() << "uplink discovery time out:" << name;
+        finish("Timed out");
+    });
+
+    socket->connectToHostEncrypted(host, 443, QIODevice::ReadWrite,
+                                   isIpv4 ? QAbstractSocket::IPv4Protocol : QAbstractSocket::IPv6Protocol);
+}
+
+void UplinkDiscovery::handleResponse(int index, bool isIpv4, const QByteArray &response)
+{
+    Uplink &uplink = uplinks_[index];
+    const QString family = isIpv4 ? "IPv4" : "IPv6";
+
+    const qsizetype headerEnd = response.indexOf("\r\n\r\n");
+    const QList<QByteArray> statusLine = response.left(response.indexOf("\r\n")).split(' ');
+    if (headerEnd < 0 || statusLine.size() < 2 || statusLine.at(1) != "200") {
+        emit failed(uplink.name, isIpv4, QString("Failed to get %1").arg(family));
+        return;
+    }
+
+    // 与默认出口的发现相同，兼容纯文本响应
+    const QString address = IpDiscovery::parseReply(response.mid(headerEnd + 4), isIpv4);
+    if (address.isEmpty()) {
+        emit failed(uplink.name, isIpv4, QString("No public %1").arg(family));
+        return;
+    }
+
+    QString &current = isIpv4 ? uplink.ipv4 : uplink.ipv6;
+    if (current == address) {
+        return;
+    }
+    qInfo() << QString("uplink %1 %2 changed: %3 -> %4").arg(uplink.name, family, current, address);
+    current = address;
+    emit addressChanged(uplink.name, isIpv4, current);
+}
+
+void UplinkDiscovery::finishQuery()
+{
+    if (--pending_ == 0) {
+        emit finished();
+    }
+}
+
+QList<DnsRecord> UplinkDiscovery::records(const QString &name) const
+{
+    QList<DnsRecord> records;
+    for (const Uplink &uplink : uplinks_) {
+        if (!name.isEmpty() && uplink.name != name) {
+            continue;
+        }
+        if (!uplink.ipv4.isEmpty() && !uplink.ipv4RecordName.isEmpty()) {
+            records.append({"A", uplink.ipv4RecordName, uplink.ipv4});
+        }
+        if (!uplink.ipv6.isEmpty() && !uplink.ipv6RecordName.isEmpty()) {
+            records.append({"AAAA", uplink.ipv6RecordName, uplink.ipv6});
+        }
+    }
+    return records;
+}
+
+QStringList UplinkDiscovery::recordNames() const
+{
+    QStringList names;
+    for (const Uplink &uplink : uplinks_) {
+        for (const QString &name : {uplink.ipv4RecordName, uplink.ipv6RecordName}) {
+            if (!name.isEmpty()) {
+                names.append(name);
+            }
+        }
+    }
+    return names;
+}
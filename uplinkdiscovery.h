@@ -0,0 +1,71 @@
+#ifndef UPLINKDISCOVERY_H
+#define UPLINKDISCOVERY_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QNetworkInterface>
+
+#include "dnsprovider.h"
+
+// 多出口：每条上行链路从自己的源地址查询公网地址，结果写入该链路各自的记录
+//
+// QNetworkAccessManager 不能指定源地址，这里直接用绑定了源地址的 QSslSocket 向 ipify 发送请求，
+// 配合按源地址选路的策略路由，请求会从对应的出口发出。
+class UplinkDiscovery : public QObject
+{
+    Q_OBJECT
+public:
+    struct Uplink {
+        QString name;
+        QString interfaceName;
+        // 未指定源地址时取接口上的地址
+        QHostAddress source;
+        QString ipv4RecordName;
+        QString ipv6RecordName;
+
+        QString ipv4;
+        QString ipv6;
+    };
+
+    explicit UplinkDiscovery(QObject *parent = nullptr) : QObject(parent) {}
+
+    // 与网络设置页面列出的接口相同：已启用、正在运行且不是回环
+    static QList<QNetworkInterface> usableInterfaces();
+
+    void loadConfig(const QJsonArray &config);
+    bool isEmpty() const { return uplinks_.isEmpty(); }
+    const QList<Uplink> &uplinks() const { return uplinks_; }
+
+    // 所有链路的两个地址族同时查询
+    void discover(int timeout = 30000);
+    bool isRunning() const { return pending_ > 0; }
+
+    // 各链路已发现地址对应的记录，指定 uplink 时只返回该链路的记录
+    QList<DnsRecord> records(const QString &uplink = QString()) const;
+    // 配置的全部记录名，不论是否已发现地址
+    QStringList recordNames() const;
+
+signals:
+    void addressChanged(const QString &uplink, bool isIpv4, const QString &address);
+    void failed(const QString &uplink, bool isIpv4, const QString &reason);
+    void finished();
+
+private:
+    // 链路在该地址族下使用的源地址，没有可用地址时返回空地址
+    QHostAddress sourceAddress(const Uplink &uplink, bool isIpv4) const;
+    void query(int index, bool isIpv4, const QHostAddress &source, int timeout);
+    void handleResponse(int index, bool isIpv4, const QByteArray &response);
+    void finishQuery();
+
+private:
+    QList<Uplink> uplinks_;
+    int pending_ = 0;
+    // 重新加载配置后，旧查询的结果不再计入
+    quint64 generation_ = 0;
+};
+
+#endif // UPLINKDISCOVERY_H